@@ -9,6 +9,7 @@
 
 
 #include <DebouncedButton.h>
+#include <ScanRateController.h>
 
 constexpr static int BUTTON_PIN = 2;
 
@@ -21,6 +22,10 @@ constexpr static bool PRESSED_STATE = true;
 
 DebouncedButton button(PRESSED_STATE);
 
+// Scans every 50ms while the button is idle, and every 1ms while a gesture is
+// underway.
+ScanRateController scan_rate;
+
 void setup()
 {
     Serial.begin(115200);
@@ -30,15 +35,19 @@ void setup()
 
 void loop()
 {
-    auto now = millis();
+    // Wait for the next scan rather than spinning on millis(); elapsed()
+    // is 0 if the scan is already due.
+    delay(DebouncedButton::elapsed(millis(), scan_rate.next_scan_tm()));
 
+    auto now = millis();
+    scan_rate.begin_scan();
     auto input = button.update(digitalRead(BUTTON_PIN), now);
+    scan_rate.observe(button);
+    scan_rate.end_scan(now);
 
     if (input != DebouncedButton::NONE) {
         Serial.print("Received input ");
         Serial.println(button.describe_input(input));
     }
-
-    delay(10);
 }
 
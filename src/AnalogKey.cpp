@@ -0,0 +1,37 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "AnalogKey.h"
+
+/*-------------------------------------------------------------------------*/
+
+AnalogKey::AnalogKey(RapidTrigger const& settings, uint8_t profile_index)
+    : _settings(settings)
+    , _button(true, profile_index)
+{ }
+
+DebouncedButton::Input
+AnalogKey::update(uint16_t travel, uint32_t tm)
+{
+    _pressed = rapid_trigger(_settings, _pressed, _extremum, travel);
+    return _button.update_debounced(_pressed, tm);
+}
+
+/*-------------------------------------------------------------------------*/
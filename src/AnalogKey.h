@@ -0,0 +1,178 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef analog_key_h
+#define analog_key_h
+
+#include "ButtonBank.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Settings for keys that report continuous travel, such as Hall effect keys,
+ * in the units of the travel readings with 0 at rest. A key can only be
+ * pressed beyond the actuation point, and within that range a "rapid trigger"
+ * presses it whenever it moves down press_delta from its highest point since
+ * the last release, and releases it whenever it moves up release_delta from
+ * its lowest point since the last press.
+ */
+struct RapidTrigger
+{
+    uint16_t actuation;
+    uint16_t press_delta;
+    uint16_t release_delta;
+};
+
+/**
+ * Steps the rapid trigger for one key with its latest travel reading, and
+ * returns whether it's pressed. The extremum is the key's highest point while
+ * released or its lowest point while pressed, and starts at 0.
+ */
+inline bool rapid_trigger(RapidTrigger const& settings, bool pressed, uint16_t& extremum, uint16_t travel)
+{
+    if (pressed) {
+        if (travel > extremum)
+            extremum = travel;
+        if (travel < settings.actuation || travel + settings.release_delta <= extremum) {
+            extremum = travel;
+            return false;
+        }
+    } else {
+        if (travel < extremum)
+            extremum = travel;
+        if (travel >= settings.actuation && travel >= extremum + settings.press_delta) {
+            extremum = travel;
+            return true;
+        }
+    }
+    return pressed;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A key that reports continuous travel, pressed and released by a rapid
+ * trigger, with the same gesture recognition as a DebouncedButton.
+ */
+class AnalogKey
+{
+    RapidTrigger _settings;
+    DebouncedButton _button;
+    uint16_t _extremum = 0;
+    bool _pressed = false;
+
+public:
+    /**
+     * Creates a new instance with the specified rapid trigger settings.
+     */
+    AnalogKey(RapidTrigger const& settings, uint8_t profile_index = 0);
+
+    /**
+     * Adds a travel reading to the key, and returns any recognized Input.
+     */
+    DebouncedButton::Input update(uint16_t travel, uint32_t tm);
+
+    DebouncedButton& button() { return _button; }
+    DebouncedButton const& button() const { return _button; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * KEYS analog keys sharing rapid trigger settings, updated together from an
+ * array of travel readings using only integer operations. Pressed states are
+ * gathered into words of 32 keys, and only keys whose state changed or that
+ * are waiting on a gesture timeout have their gesture state updated.
+ */
+template <uint16_t KEYS>
+class AnalogKeyBank
+{
+public:
+    static const uint32_t WORDS = (KEYS + 31) / 32;
+
+private:
+    RapidTrigger _settings;
+    uint16_t _extremum[KEYS] = {};
+    ButtonBank<uint32_t> _banks[WORDS];
+
+public:
+    /**
+     * Creates a new instance with the specified rapid trigger settings.
+     */
+    AnalogKeyBank(RapidTrigger const& settings)
+        : _settings(settings)
+    { }
+
+    /**
+     * Adds a travel reading of every key, calling on_input(key, input) for
+     * each recognized Input.
+     */
+    template <typename F>
+    void update(uint16_t const (&travel)[KEYS], uint32_t tm, F&& on_input)
+    {
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            uint32_t base = w * 32;
+            uint32_t end = base + 32 < KEYS ? base + 32 : KEYS;
+            uint32_t prev = _banks[w].state();
+            uint32_t pressed = 0;
+            for (uint32_t k = base; k < end; ++k) {
+                bool was = (prev >> (k - base)) & 1;
+                pressed |= uint32_t(rapid_trigger(_settings, was, _extremum[k], travel[k])) << (k - base);
+            }
+            _banks[w].update(pressed, tm, [&](uint8_t i, DebouncedButton::Input input) {
+                on_input(base + i, input);
+            });
+        }
+    }
+
+    /**
+     * Returns true if the key is pressed.
+     */
+    bool pressed(uint16_t key) const { return (_banks[key / 32].state() >> (key % 32)) & 1; }
+
+    /**
+     * Bulk queries as for ButtonBank, as packed bitsets with bit i % 32 of
+     * word i / 32 for key i.
+     */
+    void pressed_mask(uint32_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w)
+            mask[w] = _banks[w].pressed_mask();
+    }
+
+    void pending_mask(uint32_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w)
+            mask[w] = _banks[w].pending_mask();
+    }
+
+    void changed_since(uint32_t tm, uint32_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w)
+            mask[w] = _banks[w].changed_since(tm);
+    }
+
+    DebouncedButton& button(uint16_t key) { return _banks[key / 32].button(key % 32); }
+    DebouncedButton const& button(uint16_t key) const { return _banks[key / 32].button(key % 32); }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,155 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef bit_ops_h
+#define bit_ops_h
+
+#ifdef UNIT_TESTING
+#include <cstdint>
+#else
+#include <Arduino.h>
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+// Bit manipulation helpers for the multi-button front ends. These use the
+// compiler builtins, which become single instructions where the target has
+// them and small library routines elsewhere.
+
+/**
+ * Returns the index of the lowest set bit in word, which must not be 0.
+ */
+inline uint8_t count_trailing_zeros(uint32_t word) { return __builtin_ctzl(word); }
+inline uint8_t count_trailing_zeros(uint64_t word) { return __builtin_ctzll(word); }
+inline uint8_t count_trailing_zeros(uint16_t word) { return __builtin_ctzl(word); }
+inline uint8_t count_trailing_zeros(uint8_t word) { return __builtin_ctzl(word); }
+
+/**
+ * Returns the index of the highest set bit in word, which must not be 0.
+ */
+inline uint8_t highest_bit(uint32_t word) { return sizeof(unsigned long) * 8 - 1 - __builtin_clzl(word); }
+
+/**
+ * Returns the number of set bits in word. Hosts get a single instruction
+ * when compiled for a CPU that has one (e.g. -mpopcnt on x86); AVR has no
+ * such instruction and uses a nibble table, which beats the library routine.
+ */
+#ifdef __AVR__
+inline uint8_t popcount(uint8_t word)
+{
+    static const uint8_t NIBBLE_BITS[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    return NIBBLE_BITS[word & 0x0f] + NIBBLE_BITS[word >> 4];
+}
+inline uint8_t popcount(uint16_t word) { return popcount(uint8_t(word)) + popcount(uint8_t(word >> 8)); }
+inline uint8_t popcount(uint32_t word) { return popcount(uint16_t(word)) + popcount(uint16_t(word >> 16)); }
+inline uint8_t popcount(uint64_t word) { return popcount(uint32_t(word)) + popcount(uint32_t(word >> 32)); }
+#else
+inline uint8_t popcount(uint32_t word) { return __builtin_popcountl(word); }
+inline uint8_t popcount(uint64_t word) { return __builtin_popcountll(word); }
+inline uint8_t popcount(uint16_t word) { return __builtin_popcountl(word); }
+inline uint8_t popcount(uint8_t word) { return __builtin_popcountl(word); }
+#endif
+
+/**
+ * Calls f with the index of each set bit in word, lowest first.
+ */
+template <typename Word, typename F>
+inline void for_each_bit(Word word, F&& f)
+{
+    while (word) {
+        f(count_trailing_zeros(word));
+        word &= word - 1;
+    }
+}
+
+/**
+ * Returns true if any, or all, of the bits of group are set in mask. The
+ * array forms take packed bitsets of N words.
+ */
+template <typename Word>
+inline bool any_of(Word mask, Word group) { return (mask & group) != 0; }
+
+template <typename Word>
+inline bool all_of(Word mask, Word group) { return (mask & group) == group; }
+
+template <typename Word, uint32_t N>
+inline bool any_of(Word const (&mask)[N], Word const (&group)[N])
+{
+    for (uint32_t i = 0; i < N; ++i)
+        if (mask[i] & group[i])
+            return true;
+    return false;
+}
+
+template <typename Word, uint32_t N>
+inline bool all_of(Word const (&mask)[N], Word const (&group)[N])
+{
+    for (uint32_t i = 0; i < N; ++i)
+        if ((mask[i] & group[i]) != group[i])
+            return false;
+    return true;
+}
+
+/**
+ * Transposes the square bit matrix whose rows are the words of m, so that
+ * bit j of m[i] becomes bit i of m[j]. Blocks of half the size are swapped
+ * first, then quarters and so on, which takes log2(bits) passes over m.
+ */
+template <typename Word>
+inline void transpose(Word (&m)[sizeof(Word) * 8])
+{
+    const uint8_t N = sizeof(Word) * 8;
+    Word mask = Word(~Word(0)) >> (N / 2);
+    for (uint8_t j = N / 2; j; j >>= 1, mask ^= Word(mask << j)) {
+        for (uint8_t k = 0; k < N; k = (k + j + 1) & ~j) {
+            Word t = Word((m[k] >> j) ^ m[k + j]) & mask;
+            m[k] ^= Word(t << j);
+            m[k + j] ^= t;
+        }
+    }
+}
+
+#ifndef __AVR__
+/**
+ * An 8x8 matrix fits in one 64-bit register, where each pass is a single
+ * masked swap of all the blocks at once.
+ */
+inline void transpose(uint8_t (&m)[8])
+{
+    uint64_t x = 0;
+    for (uint8_t i = 0; i < 8; ++i)
+        x |= uint64_t(m[i]) << (8 * i);
+
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aa;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000cccc;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0;
+    x ^= t ^ (t << 28);
+
+    for (uint8_t i = 0; i < 8; ++i)
+        m[i] = uint8_t(x >> (8 * i));
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,180 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef bit_stream_bank_h
+#define bit_stream_bank_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A DebouncedButton for each bit of a word, fed from blocks of samples such as
+ * those captured by DMA from a port. A block holds one word per sample, taken
+ * at a fixed interval. The block is transposed so each button's samples form
+ * a bit stream, and a button is only updated at the samples where its reading
+ * changes or where it is waiting on a timeout, which gives the same Inputs as
+ * updating it with every sample.
+ */
+template <typename Word>
+class BitStreamBank
+{
+public:
+    static const uint8_t SIZE = sizeof(Word) * 8;
+
+    // Changes older than this are forgotten by changed_since().
+    static const uint32_t CHANGE_HORIZON_MS = uint32_t(1) << 30;
+
+private:
+    Word _invert;
+    Word _last = 0;
+    Word _pressed = 0;
+    Word _pending = 0;
+    Word _changed = 0;
+    uint32_t _change_tm = 0;
+    uint32_t _prune_tm = 0;
+    DebouncedButton _buttons[SIZE];
+
+    template <typename F>
+    void update_stream(uint8_t index, Word stream, uint32_t tm, uint32_t interval_ms, F&& on_input)
+    {
+        DebouncedButton& button = _buttons[index];
+        Word bit = Word(1) << index;
+        Word edges = stream ^ Word((stream << 1) | ((_last >> index) & 1));
+
+        for (uint8_t k = 0; k < SIZE; ++k) {
+            // Jump to the next reading change, or to the next deadline if that
+            // comes first.
+            Word ahead = edges >> k;
+            uint8_t next = ahead ? k + count_trailing_zeros(ahead) : SIZE;
+
+            uint32_t deadline_tm;
+            if (button.next_deadline(deadline_tm)) {
+                uint32_t wait = DebouncedButton::elapsed(tm + k * interval_ms, deadline_tm);
+                uint32_t samples = (wait + interval_ms - 1) / interval_ms;
+                if (k + samples < next)
+                    next = k + samples;
+            }
+
+            if (next >= SIZE)
+                break;
+
+            k = next;
+            uint32_t sample_tm = tm + k * interval_ms;
+            auto input = button.update((stream >> k) & 1, sample_tm);
+            if (input != DebouncedButton::NONE)
+                on_input(index, input);
+
+            if (button.state() != bool(_pressed & bit)) {
+                // Streams are visited button by button, so keep the latest
+                // change time of the block.
+                if (!_changed)
+                    _prune_tm = sample_tm + CHANGE_HORIZON_MS / 2;
+                if (!_changed || DebouncedButton::reached(_change_tm, sample_tm))
+                    _change_tm = sample_tm;
+                _pressed ^= bit;
+                _changed |= bit;
+            }
+        }
+
+        if (button.input_pending())
+            _pending |= bit;
+        else
+            _pending &= ~bit;
+    }
+
+public:
+    /**
+     * Creates a new instance with the specified polarity, which has a bit set
+     * for each input that reads 1 when its button is pressed.
+     */
+    BitStreamBank(Word pressed_state = Word(~Word(0)))
+        : _invert(~pressed_state)
+    { }
+
+    /**
+     * Adds a block of samples of every button, the first taken at tm and the
+     * rest every interval_ms after it, calling on_input(index, input) for each
+     * recognized Input. The block is transposed in place.
+     */
+    template <typename F>
+    void update(Word (&samples)[SIZE], uint32_t tm, uint32_t interval_ms, F&& on_input)
+    {
+        for (uint8_t k = 0; k < SIZE; ++k)
+            samples[k] ^= _invert;
+        Word last = samples[SIZE - 1];
+
+        transpose(samples);
+        for (uint8_t i = 0; i < SIZE; ++i)
+            update_stream(i, samples[i], tm, interval_ms, on_input);
+
+        _last = last;
+
+        // Every half horizon, forget the changes older than the horizon, so
+        // that none is old enough to look recent after millis() wraps.
+        uint32_t end_tm = tm + (SIZE - 1) * interval_ms;
+        if (_changed && DebouncedButton::reached(_prune_tm, end_tm)) {
+            for_each_bit(_changed, [&](uint8_t i) {
+                if (end_tm - _buttons[i].last_change_tm() >= CHANGE_HORIZON_MS)
+                    _changed &= ~(Word(1) << i);
+            });
+            _prune_tm = end_tm + CHANGE_HORIZON_MS / 2;
+        }
+    }
+
+    /**
+     * Returns a mask of the buttons whose debounced state is pressed at the
+     * end of the latest block.
+     */
+    Word pressed_mask() const { return _pressed; }
+
+    /**
+     * Returns a mask of the buttons with an Input pending.
+     */
+    Word pending_mask() const { return _pending; }
+
+    /**
+     * Returns a mask of the buttons whose debounced state has changed at or
+     * after tm, which must be within CHANGE_HORIZON_MS of the latest block.
+     * Unless no change is that recent, the change time of each button that
+     * changed within the horizon is checked in turn.
+     */
+    Word changed_since(uint32_t tm) const
+    {
+        Word changed = 0;
+        if (!_changed || !DebouncedButton::reached(tm, _change_tm))
+            return changed;
+        for_each_bit(_changed, [&](uint8_t i) {
+            if (DebouncedButton::reached(tm, _buttons[i].last_change_tm()))
+                changed |= Word(1) << i;
+        });
+        return changed;
+    }
+
+    DebouncedButton& button(uint8_t index) { return _buttons[index]; }
+    DebouncedButton const& button(uint8_t index) const { return _buttons[index]; }
+};
+
+template <typename Word> const uint32_t BitStreamBank<Word>::CHANGE_HORIZON_MS;
+
+/*---------------------------------------------------------------------------*/
+
+#endif
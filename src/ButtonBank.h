@@ -0,0 +1,161 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef button_bank_h
+#define button_bank_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A DebouncedButton for each bit of a word, driven by a mask of debounced
+ * states from a front end that debounces the whole word at once. Only buttons
+ * whose debounced state changed, or whose gesture timeout has been reached,
+ * have their gesture state updated. Each button's next deadline is cached
+ * when it's updated, so on most scans the cost of the waiting buttons is one
+ * comparison of the scan time against the earliest of their deadlines.
+ */
+template <typename Word>
+class ButtonBank
+{
+public:
+    static const uint8_t SIZE = sizeof(Word) * 8;
+
+    // Changes older than this are forgotten by changed_since().
+    static const uint32_t CHANGE_HORIZON_MS = uint32_t(1) << 30;
+
+private:
+    Word _pressed = 0;
+    Word _pending = 0;
+    Word _changed = 0;
+    Word _timing = 0;
+    uint32_t _change_tm = 0;
+    uint32_t _prune_tm = 0;
+    uint32_t _next_deadline_tm = 0;
+    uint32_t _deadline_tm[SIZE];
+    DebouncedButton _buttons[SIZE];
+
+public:
+    /**
+     * Updates the buttons from the debounced state of every button, calling
+     * on_input(index, input) for each recognized Input.
+     */
+    template <typename F>
+    void update(Word pressed, uint32_t tm, F&& on_input)
+    {
+        Word due = pressed ^ _pressed;
+        _pressed = pressed;
+        if (due) {
+            if (!_changed)
+                _prune_tm = tm + CHANGE_HORIZON_MS / 2;
+            _changed |= due;
+            _change_tm = tm;
+        }
+
+        // Every half horizon, forget the changes older than the horizon, so
+        // that none is old enough to look recent after millis() wraps. The
+        // buttons changing now haven't recorded their change time yet.
+        if (_changed && DebouncedButton::reached(_prune_tm, tm)) {
+            for_each_bit(Word(_changed & ~due), [&](uint8_t i) {
+                if (tm - _buttons[i].last_change_tm() >= CHANGE_HORIZON_MS)
+                    _changed &= ~(Word(1) << i);
+            });
+            _prune_tm = tm + CHANGE_HORIZON_MS / 2;
+        }
+
+        if (_timing && DebouncedButton::reached(_next_deadline_tm, tm)) {
+            for_each_bit(_timing, [&](uint8_t i) {
+                if (DebouncedButton::reached(_deadline_tm[i], tm))
+                    due |= Word(1) << i;
+            });
+        }
+
+        if (!due)
+            return;
+
+        for_each_bit(due, [&](uint8_t i) {
+            Word bit = Word(1) << i;
+            DebouncedButton& button = _buttons[i];
+
+            auto input = button.update_debounced(pressed & bit, tm);
+            if (input != DebouncedButton::NONE)
+                on_input(i, input);
+
+            if (button.input_pending())
+                _pending |= bit;
+            else
+                _pending &= ~bit;
+
+            if (button.next_deadline(_deadline_tm[i]))
+                _timing |= bit;
+            else
+                _timing &= ~bit;
+        });
+
+        // Find the earliest deadline again, comparing by signed difference to
+        // stay correct across rollover.
+        bool first = true;
+        for_each_bit(_timing, [&](uint8_t i) {
+            if (first || int32_t(_deadline_tm[i] - _next_deadline_tm) < 0)
+                _next_deadline_tm = _deadline_tm[i];
+            first = false;
+        });
+    }
+
+    /**
+     * Returns a mask of the buttons whose debounced state is pressed.
+     */
+    Word state() const { return _pressed; }
+    Word pressed_mask() const { return _pressed; }
+
+    /**
+     * Returns a mask of the buttons with an Input pending.
+     */
+    Word pending_mask() const { return _pending; }
+
+    /**
+     * Returns a mask of the buttons whose debounced state has changed at or
+     * after tm, which must be within CHANGE_HORIZON_MS of the latest update.
+     * Unless no change is that recent, the change time of each button that
+     * changed within the horizon is checked in turn.
+     */
+    Word changed_since(uint32_t tm) const
+    {
+        Word changed = 0;
+        if (!_changed || !DebouncedButton::reached(tm, _change_tm))
+            return changed;
+        for_each_bit(_changed, [&](uint8_t i) {
+            if (DebouncedButton::reached(tm, _buttons[i].last_change_tm()))
+                changed |= Word(1) << i;
+        });
+        return changed;
+    }
+
+    DebouncedButton& button(uint8_t index) { return _buttons[index]; }
+    DebouncedButton const& button(uint8_t index) const { return _buttons[index]; }
+};
+
+template <typename Word> const uint32_t ButtonBank<Word>::CHANGE_HORIZON_MS;
+
+/*---------------------------------------------------------------------------*/
+
+#endif
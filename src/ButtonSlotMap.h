@@ -0,0 +1,166 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef button_slot_map_h
+#define button_slot_map_h
+
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Refers to a button in a ButtonSlotMap. The generation distinguishes the
+ * successive buttons held in the same slot.
+ */
+struct ButtonHandle
+{
+    uint16_t slot;
+    uint16_t generation;
+
+    bool operator==(ButtonHandle const& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(ButtonHandle const& other) const { return !(*this == other); }
+};
+
+/**
+ * Up to CAPACITY buttons that come and go at runtime, such as those of
+ * hot-plugged panels, held without any heap allocation. Buttons are referred
+ * to by handles that carry a generation, so a handle to a removed button is
+ * rejected even after its slot is reused. Adding and removing are O(1), and
+ * the buttons are kept packed together so that scanning visits only live
+ * ones.
+ */
+template <uint16_t CAPACITY>
+class ButtonSlotMap
+{
+public:
+    using Handle = ButtonHandle;
+
+    // Never returned for a live button.
+    static constexpr Handle INVALID = { 0, 0 };
+
+private:
+    // Dense storage, in the order buttons are scanned.
+    DebouncedButton _buttons[CAPACITY];
+    uint16_t _dense_slot[CAPACITY];
+    uint16_t _size = 0;
+
+    // Per slot, the dense index of a live button or the next free slot.
+    uint16_t _slot_index[CAPACITY];
+    uint16_t _generation[CAPACITY];
+    uint16_t _free = 0;
+
+public:
+    ButtonSlotMap()
+    {
+        for (uint16_t slot = 0; slot < CAPACITY; ++slot) {
+            _slot_index[slot] = slot + 1;
+            _generation[slot] = 1;
+        }
+    }
+
+    /**
+     * Adds a button with the specified polarity and profile, and returns its
+     * handle, or INVALID if the map is full.
+     */
+    Handle add(bool pressed_state = true, uint8_t profile_index = 0)
+    {
+        if (_size == CAPACITY)
+            return INVALID;
+
+        uint16_t slot = _free;
+        _free = _slot_index[slot];
+        _slot_index[slot] = _size;
+        _dense_slot[_size] = slot;
+        _buttons[_size] = DebouncedButton(pressed_state, profile_index);
+        ++_size;
+        return { slot, _generation[slot] };
+    }
+
+    /**
+     * Removes the button, moving the last one into its place. Returns false
+     * if the handle is stale.
+     */
+    bool remove(Handle handle)
+    {
+        if (!contains(handle))
+            return false;
+
+        uint16_t index = _slot_index[handle.slot];
+        uint16_t last = --_size;
+        _buttons[index] = _buttons[last];
+        _dense_slot[index] = _dense_slot[last];
+        _slot_index[_dense_slot[index]] = index;
+
+        // Generation 0 is reserved for INVALID.
+        if (++_generation[handle.slot] == 0)
+            _generation[handle.slot] = 1;
+        _slot_index[handle.slot] = _free;
+        _free = handle.slot;
+        return true;
+    }
+
+    /**
+     * Returns true if the handle refers to a live button.
+     */
+    bool contains(Handle handle) const
+    {
+        return handle.slot < CAPACITY && handle.generation == _generation[handle.slot]
+            && _slot_index[handle.slot] < _size && _dense_slot[_slot_index[handle.slot]] == handle.slot;
+    }
+
+    /**
+     * Returns the button, or nullptr if the handle is stale.
+     */
+    DebouncedButton* get(Handle handle) { return contains(handle) ? &_buttons[_slot_index[handle.slot]] : nullptr; }
+    DebouncedButton const* get(Handle handle) const { return contains(handle) ? &_buttons[_slot_index[handle.slot]] : nullptr; }
+
+    /**
+     * Updates every live button, reading each with read(handle) and calling
+     * on_input(handle, input) for each recognized Input.
+     */
+    template <typename Read, typename F>
+    void update(uint32_t tm, Read&& read, F&& on_input)
+    {
+        for (uint16_t i = 0; i < _size; ++i) {
+            Handle handle = handle_at(i);
+            auto input = _buttons[i].update(read(handle), tm);
+            if (input != DebouncedButton::NONE)
+                on_input(handle, input);
+        }
+    }
+
+    /**
+     * Returns the handle of the button at position index of the scan order.
+     */
+    Handle handle_at(uint16_t index) const
+    {
+        uint16_t slot = _dense_slot[index];
+        return { slot, _generation[slot] };
+    }
+
+    uint16_t size() const { return _size; }
+};
+
+template <uint16_t CAPACITY>
+constexpr ButtonHandle ButtonSlotMap<CAPACITY>::INVALID;
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -21,10 +21,45 @@
 
 /*-------------------------------------------------------------------------*/
 
-DebouncedButton::DebouncedButton(bool pressed_state)
+const uint32_t DebouncedButton::DEBOUNCE_MS;
+const uint32_t DebouncedButton::CLICKED_CUTOFF_MS;
+const uint32_t DebouncedButton::DOUBLE_CLICK_TIMEOUT_MS;
+const uint8_t DebouncedButton::MAX_PROFILES;
+const uint8_t DebouncedButton::HOLD_STAGES;
+
+// A default Profile must stay a constant expression so that the table is
+// constant-initialized rather than filled by a dynamic initializer.
+static_assert(DebouncedButton::Profile().debounce_ms == DebouncedButton::DEBOUNCE_MS,
+              "Profile defaults must be constant");
+static_assert(DebouncedButton::HOLD_STAGES == 3,
+              "Profile constructor takes one argument per hold stage");
+
+DebouncedButton::Profile DebouncedButton::_profiles[MAX_PROFILES];
+
+DebouncedButton::DebouncedButton(bool pressed_state, uint8_t profile_index)
     : _pressed_state(pressed_state)
+    , _profile_index(profile_index < MAX_PROFILES ? profile_index : 0)
+{ }
+
+void
+DebouncedButton::set_profile(uint8_t index, Profile const& profile)
+{
+    if (index < MAX_PROFILES)
+        _profiles[index] = profile;
+}
+
+void
+DebouncedButton::reset_profiles()
+{
+    for (uint8_t i = 0; i < MAX_PROFILES; ++i)
+        _profiles[i] = Profile();
+}
+
+void
+DebouncedButton::set_profile_index(uint8_t index)
 {
-    _prev_reading = !pressed_state;
+    if (index < MAX_PROFILES)
+        _profile_index = index;
 }
 
 DebouncedButton::Input
@@ -33,76 +68,371 @@ DebouncedButton::update(bool reading, uint32_t tm)
     if (!_pressed_state)
         reading = !reading;
 
+    Profile const& profile = _profiles[_profile_index];
+
     if (_prev_reading != reading) {
+        if (profile.min_debounce_ms < profile.debounce_ms)
+            observe_bounce(profile, tm);
+
         // If the reading has changed, begin a new debounce period.
         _last_reading_change_tm = tm;
         _prev_reading = reading;
         return NONE;
     }
 
-    auto reading_duration = tm - _last_reading_change_tm;
+    if (_debounced_reading != reading) {
+        if (elapsed(_last_reading_change_tm, tm) < pending_window(profile))
+            return NONE;
+
+        if (profile.min_debounce_ms < profile.debounce_ms)
+            learn_debounce_window(profile);
+    }
+
+    return transition(profile, reading, tm);
+}
+
+DebouncedButton::Input
+DebouncedButton::update_debounced(bool pressed, uint32_t tm)
+{
+    _prev_reading = pressed;
+    return transition(_profiles[_profile_index], pressed, tm);
+}
 
+DebouncedButton::Input
+DebouncedButton::transition(Profile const& profile, bool reading, uint32_t tm)
+{
     Input input = NONE;
 
-    if (_debounced_reading != reading) {
-        if (reading_duration < DEBOUNCE_MS)
-            return NONE;
+    // An input held back by the previous transition goes out first, and
+    // the button carries on from the state it stood in for.
+    Input deferred = NONE;
+    if (_state == CLICK_CONFIRMED_PENDING) {
+        deferred = CLICK_CONFIRMED;
+        _state = IDLE;
+    } else if (_state == CLICK_DEFERRED_PENDING) {
+        deferred = CLICK;
+        _state = CLICKED_PENDING;
+    }
+    if (deferred != NONE && _debounced_reading == reading)
+        return deferred;
 
+    if (_debounced_reading != reading) {
         // The new reading has passed the debounce period.
         if (_state == IDLE) {
+            // A press soon after a delivered click means the click should
+            // have been part of a double click.
+            if (_clicked && profile.min_double_click_timeout_ms < profile.double_click_timeout_ms
+                && duration(tm) <= profile.double_click_timeout_ms)
+                observe_click_gap(duration(tm));
             _state = PRESSED_PENDING;
+            _gesture_start_tm = tm;
         } else if (_state == PRESSED_PENDING) {
-            _state = CLICKED_PENDING;
+            if (!(profile.gestures & (GESTURE_DOUBLE_CLICK | GESTURE_CLICK_AND_LONG_PRESS))) {
+                // Nothing can follow the click, so there is no need to wait,
+                // and a provisional click is confirmed on the next update.
+                input = CLICK;
+                _state = (profile.flags & SPECULATIVE_CLICK) ? CLICK_CONFIRMED_PENDING : IDLE;
+            } else {
+                if (profile.flags & SPECULATIVE_CLICK)
+                    input = CLICK;
+                _state = CLICKED_PENDING;
+            }
         } else if (_state == PRESSED) {
             input = RELEASE;
             _state = IDLE;
         } else if (_state == CLICKED_PENDING) {
+            if (profile.min_double_click_timeout_ms < profile.double_click_timeout_ms)
+                observe_click_gap(duration(tm));
             _state = CLICKED_PRESSED_PENDING;
         } else if (_state == CLICKED_PRESSED_PENDING) {
-            _state = DOUBLE_CLICKED_PENDING;
+            if (!(profile.gestures & GESTURE_DOUBLE_CLICK)) {
+                // Two separate clicks, the second of which may be extended.
+                // When speculating, the first click's provisional CLICK is
+                // confirmed now and the second's is delivered on the next
+                // update.
+                if (profile.flags & SPECULATIVE_CLICK) {
+                    input = CLICK_CONFIRMED;
+                    _state = CLICK_DEFERRED_PENDING;
+                } else {
+                    input = CLICK;
+                    _state = CLICKED_PENDING;
+                }
+                _gesture_start_tm = _last_change_tm;
+            } else if (!(profile.gestures & GESTURE_DOUBLE_CLICK_AND_LONG_PRESS)) {
+                input = (profile.flags & SPECULATIVE_CLICK) ? CLICK_UPGRADED_TO_DOUBLE : DOUBLE_CLICK;
+                _state = IDLE;
+            } else {
+                if (profile.flags & SPECULATIVE_CLICK)
+                    input = CLICK_UPGRADED_TO_DOUBLE;
+                _state = DOUBLE_CLICKED_PENDING;
+            }
         } else if (_state == DOUBLE_CLICKED_PENDING) {
             _state = DOUBLE_CLICKED_PRESSED_PENDING;
         } else if (_state == DOUBLE_CLICKED_PRESSED_PENDING) {
-            input = DOUBLE_CLICK;
+            // The double click was already upgraded when speculating, so
+            // this release is the provisional click of a new gesture.
+            input = (profile.flags & SPECULATIVE_CLICK) ? CLICK : DOUBLE_CLICK;
             _state = CLICKED_PENDING;
+            _gesture_start_tm = _last_change_tm;
         }
 
+        // A deferred input leaves IDLE or CLICKED_PENDING, and the changes
+        // out of those deliver nothing themselves.
+        if (deferred != NONE)
+            input = deferred;
+
+        _clicked = false;
+        _hold_stage = 0;
         _debounced_reading = reading;
         _prev_last_change_tm = _last_change_tm;
         _last_change_tm = tm;
 
     } else {
         if (_state == CLICKED_PENDING) {
-            if (duration(tm) > DOUBLE_CLICK_TIMEOUT_MS) {
-                input = CLICK;
+            if (duration(tm) > double_click_timeout(profile)) {
+                if (profile.min_double_click_timeout_ms < profile.double_click_timeout_ms)
+                    shrink_double_click_timeout(profile);
+                input = (profile.flags & SPECULATIVE_CLICK) ? CLICK_CONFIRMED : CLICK;
                 _state = IDLE;
+                _clicked = true;
             }
         } else if (_state == PRESSED_PENDING) {
-            if (duration(tm) >= CLICKED_CUTOFF_MS) {
+            if (duration(tm) >= profile.clicked_cutoff_ms) {
                 input = LONG_PRESS;
                 _state = PRESSED;
             }
         } else if (_state == CLICKED_PRESSED_PENDING) {
-            if (duration(tm) >= CLICKED_CUTOFF_MS) {
-                input = CLICK_AND_LONG_PRESS;
-                _state = PRESSED;
+            if (duration(tm) >= profile.clicked_cutoff_ms) {
+                if (profile.gestures & GESTURE_CLICK_AND_LONG_PRESS) {
+                    input = CLICK_AND_LONG_PRESS;
+                    _state = PRESSED;
+                } else {
+                    // Deliver the click now and the long press on the next
+                    // update.
+                    input = (profile.flags & SPECULATIVE_CLICK) ? CLICK_CONFIRMED : CLICK;
+                    _state = PRESSED_PENDING;
+                    _gesture_start_tm = _last_change_tm;
+                }
             }
         } else if (_state == DOUBLE_CLICKED_PENDING) {
-            if (duration(tm) >= CLICKED_CUTOFF_MS) {
-                input = DOUBLE_CLICK;
+            if (duration(tm) >= profile.clicked_cutoff_ms) {
+                if (!(profile.flags & SPECULATIVE_CLICK))
+                    input = DOUBLE_CLICK;
                 _state = IDLE;
             }
         } else if (_state == DOUBLE_CLICKED_PRESSED_PENDING) {
-            if (duration(tm) >= CLICKED_CUTOFF_MS) {
+            if (duration(tm) >= profile.clicked_cutoff_ms) {
                 input = DOUBLE_CLICK_AND_LONG_PRESS;
                 _state = PRESSED;
             }
+        } else if (_state == PRESSED) {
+            if (_hold_stage < HOLD_STAGES && profile.hold_stage_ms[_hold_stage]
+                && duration(tm) >= profile.hold_stage_ms[_hold_stage]) {
+                input = Input(HOLD_STAGE_1 + _hold_stage);
+                ++_hold_stage;
+            }
         }
     }
 
     return input;
 }
 
+DebouncedButton::Event
+DebouncedButton::update_event(bool reading, uint32_t tm)
+{
+    State prev_state = _state;
+    bool prev_reading = _debounced_reading;
+    uint32_t gesture_start_tm = _gesture_start_tm;
+    uint32_t prev_last_change_tm = _prev_last_change_tm;
+
+    Event event = { update(reading, tm), 0, 0, 0 };
+    Profile const& profile = _profiles[_profile_index];
+
+    switch (event.input) {
+        case NONE:
+            break;
+        case CLICK:
+        case CLICK_CONFIRMED:
+        case DOUBLE_CLICK:
+            event.presses = event.input == DOUBLE_CLICK ? 2 : 1;
+            event.start_tm = gesture_start_tm;
+            event.end_tm = _last_change_tm;
+            if (prev_state == DOUBLE_CLICKED_PRESSED_PENDING && event.input == CLICK) {
+                // A speculative click that began a new gesture.
+                event.start_tm = _gesture_start_tm;
+            } else if (prev_state == DOUBLE_CLICKED_PRESSED_PENDING
+                       || (prev_state == CLICKED_PRESSED_PENDING && event.presses == 1)) {
+                // Delivered because of the press that followed the gesture,
+                // so the gesture ended with the release before that press.
+                event.end_tm = prev_last_change_tm;
+            } else if (_debounced_reading != prev_reading
+                       && (prev_state == CLICK_CONFIRMED_PENDING || prev_state == CLICK_DEFERRED_PENDING)) {
+                // A deferred click delivered along with the press after it.
+                event.end_tm = _prev_last_change_tm;
+            }
+            break;
+        case CLICK_UPGRADED_TO_DOUBLE:
+            event.presses = 2;
+            event.start_tm = gesture_start_tm;
+            event.end_tm = _last_change_tm;
+            break;
+        case LONG_PRESS:
+        case CLICK_AND_LONG_PRESS:
+        case DOUBLE_CLICK_AND_LONG_PRESS:
+            event.presses = 1 + event.input - LONG_PRESS;
+            event.start_tm = gesture_start_tm;
+            event.end_tm = _last_change_tm + profile.clicked_cutoff_ms;
+            break;
+        case RELEASE:
+            event.presses = 1;
+            event.start_tm = _prev_last_change_tm;
+            event.end_tm = _last_change_tm;
+            break;
+        case HOLD_STAGE_1:
+        case HOLD_STAGE_2:
+        case HOLD_STAGE_3:
+            event.presses = 1;
+            event.start_tm = _last_change_tm;
+            event.end_tm = _last_change_tm + profile.hold_stage_ms[event.input - HOLD_STAGE_1];
+            break;
+    }
+
+    return event;
+}
+
+bool
+DebouncedButton::next_deadline(uint32_t& deadline_tm) const
+{
+    Profile const& profile = _profiles[_profile_index];
+
+    // Timeouts are suspended while a reading change is being debounced.
+    if (debouncing()) {
+        deadline_tm = _last_reading_change_tm + pending_window(profile);
+        return true;
+    }
+
+    switch (_state) {
+        case IDLE:
+            return false;
+        case CLICK_CONFIRMED_PENDING:
+        case CLICK_DEFERRED_PENDING:
+            deadline_tm = _last_change_tm;
+            return true;
+        case PRESSED:
+            if (_hold_stage >= HOLD_STAGES || !profile.hold_stage_ms[_hold_stage])
+                return false;
+            deadline_tm = _last_change_tm + profile.hold_stage_ms[_hold_stage];
+            return true;
+        case CLICKED_PENDING:
+            deadline_tm = _last_change_tm + double_click_timeout(profile) + 1;
+            return true;
+        default:
+            deadline_tm = _last_change_tm + profile.clicked_cutoff_ms;
+            return true;
+    }
+}
+
+uint32_t
+DebouncedButton::debounce_window(Profile const& profile) const
+{
+    if (profile.min_debounce_ms >= profile.debounce_ms)
+        return profile.debounce_ms;
+    if (_debounce_ms < profile.min_debounce_ms)
+        return profile.min_debounce_ms;
+    if (_debounce_ms > profile.debounce_ms)
+        return profile.debounce_ms;
+    return _debounce_ms;
+}
+
+uint32_t
+DebouncedButton::pending_window(Profile const& profile) const
+{
+    // The debounce period for the change being debounced.
+    uint32_t window = debounce_window(profile);
+    if (_debounced_reading && profile.release_debounce_ms < window)
+        return profile.release_debounce_ms;
+    return window;
+}
+
+uint32_t
+DebouncedButton::double_click_timeout(Profile const& profile) const
+{
+    if (profile.min_double_click_timeout_ms >= profile.double_click_timeout_ms)
+        return profile.double_click_timeout_ms;
+    if (_double_click_ms < profile.min_double_click_timeout_ms)
+        return profile.min_double_click_timeout_ms;
+    if (_double_click_ms > profile.double_click_timeout_ms)
+        return profile.double_click_timeout_ms;
+    return _double_click_ms;
+}
+
+void
+DebouncedButton::observe_bounce(Profile const& profile, uint32_t tm)
+{
+    // Edges arrive in time order, so even a gap of 2^31 ms or more after a
+    // long idle period is a plain modular difference.
+    uint32_t gap = tm - _last_reading_change_tm;
+    if (gap >= profile.debounce_ms) {
+        // First edge of a new transition.
+        _bounce_ms = 0;
+    } else if (duration(tm) < gap) {
+        // The reading bounced after the debounced state changed, so that
+        // change was accepted too early; fall back to the full period.
+        _debounce_ms = UINT16_MAX;
+    } else {
+        // Accumulate the time between edges so _bounce_ms spans the first
+        // to the last edge of the transition.
+        uint32_t bounce_ms = _bounce_ms + gap;
+        _bounce_ms = bounce_ms < UINT8_MAX ? bounce_ms : UINT8_MAX;
+    }
+}
+
+void
+DebouncedButton::learn_debounce_window(Profile const& profile)
+{
+    // Allow half again the observed settle time, growing immediately when
+    // the switch gets noisier and shrinking by 1/8 of the excess otherwise.
+    uint32_t window = debounce_window(profile);
+    uint32_t target = _bounce_ms + _bounce_ms / 2 + 1;
+    if (target < window)
+        window -= (window - target + 7) / 8;
+    else
+        window = target;
+    _debounce_ms = window < UINT16_MAX ? window : UINT16_MAX;
+}
+
+void
+DebouncedButton::observe_click_gap(uint32_t gap)
+{
+    // Running mean and mean deviation of the gaps between the clicks of a
+    // double click, estimated the way TCP estimates round-trip times.
+    if (_click_gap_avg == 0) {
+        _click_gap_avg = gap;
+        _click_gap_dev = gap / 2;
+    } else {
+        int32_t err = int32_t(gap) - int32_t(_click_gap_avg);
+        _click_gap_avg += err / 8;
+        _click_gap_dev += ((err < 0 ? -err : err) - int32_t(_click_gap_dev)) / 4;
+    }
+
+    // Widen the timeout immediately to cover the observed cadence.
+    uint32_t needed = uint32_t(_click_gap_avg) + 4 * uint32_t(_click_gap_dev);
+    if (needed > _double_click_ms)
+        _double_click_ms = needed < UINT16_MAX ? needed : UINT16_MAX;
+}
+
+void
+DebouncedButton::shrink_double_click_timeout(Profile const& profile)
+{
+    // Each single click tightens the timeout by 1/16 of its excess over
+    // what the observed double clicks need.
+    uint32_t timeout = double_click_timeout(profile);
+    uint32_t needed = uint32_t(_click_gap_avg) + 4 * uint32_t(_click_gap_dev);
+    if (timeout > needed)
+        timeout -= (timeout - needed + 15) / 16;
+    _double_click_ms = timeout;
+}
+
 const char*
 DebouncedButton::describe_input(Input input) const
 {
@@ -114,6 +444,11 @@ DebouncedButton::describe_input(Input input) const
         case CLICK_AND_LONG_PRESS:        return "click and long press";
         case DOUBLE_CLICK_AND_LONG_PRESS: return "double click and long press";
         case RELEASE:                     return "release";
+        case CLICK_CONFIRMED:             return "click confirmed";
+        case CLICK_UPGRADED_TO_DOUBLE:    return "click upgraded to double";
+        case HOLD_STAGE_1:                return "hold stage 1";
+        case HOLD_STAGE_2:                return "hold stage 2";
+        case HOLD_STAGE_3:                return "hold stage 3";
         default:                          return "unknown";
     }
     // Unreachable
@@ -122,6 +457,8 @@ DebouncedButton::describe_input(Input input) const
 bool
 DebouncedButton::input_pending() const
 {
+    if (_state == DOUBLE_CLICKED_PENDING)
+        return !(_profiles[_profile_index].flags & SPECULATIVE_CLICK);
     return _state != IDLE && _state != PRESSED;
 }
 
@@ -21,13 +21,16 @@
 #define debounced_button_h
 
 #ifdef UNIT_TESTING
-#include <algorithm>
 #include <cstdint>
-#define max std::max
 #else
 #include <Arduino.h>
 #endif
 
+// The number of entries in the timing profile table shared by all buttons.
+#ifndef DEBOUNCED_BUTTON_MAX_PROFILES
+#define DEBOUNCED_BUTTON_MAX_PROFILES 4
+#endif
+
 /*---------------------------------------------------------------------------*/
 
 /**
@@ -44,6 +47,11 @@ public:
         CLICK_AND_LONG_PRESS,
         DOUBLE_CLICK_AND_LONG_PRESS,
         RELEASE,
+        CLICK_CONFIRMED,
+        CLICK_UPGRADED_TO_DOUBLE,
+        HOLD_STAGE_1,
+        HOLD_STAGE_2,
+        HOLD_STAGE_3,
     };
 
     // The button's state must be different for at least this long to cause
@@ -56,12 +64,120 @@ public:
 
     static const uint32_t DOUBLE_CLICK_TIMEOUT_MS = 150;
 
+    // The number of HOLD_STAGE_ inputs.
+    static const uint8_t HOLD_STAGES = 3;
+
+    /**
+     * A set of timing parameters. Profiles live in a table shared by all
+     * buttons, and each button refers to its profile by index, so changing a
+     * profile at runtime affects every button using it. A default-constructed
+     * Profile holds the default timing constants above, and since its
+     * constructor is constexpr, the table is filled before any static
+     * initializer could call set_profile(). The constructor takes the fields
+     * in order, so a Profile can also be brace-initialized from its leading
+     * fields, as in { 10, 150, 300 }.
+     */
+    struct Profile {
+        constexpr Profile(uint32_t debounce_ms = DEBOUNCE_MS,
+                          uint32_t clicked_cutoff_ms = CLICKED_CUTOFF_MS,
+                          uint32_t double_click_timeout_ms = DOUBLE_CLICK_TIMEOUT_MS,
+                          uint32_t min_debounce_ms = DEBOUNCE_MS,
+                          uint32_t min_double_click_timeout_ms = DOUBLE_CLICK_TIMEOUT_MS,
+                          uint8_t flags = 0,
+                          uint8_t gestures = ALL_GESTURES,
+                          uint32_t hold_stage_1_ms = 0,
+                          uint32_t hold_stage_2_ms = 0,
+                          uint32_t hold_stage_3_ms = 0,
+                          uint32_t release_debounce_ms = DEBOUNCE_MS)
+            : debounce_ms(debounce_ms)
+            , clicked_cutoff_ms(clicked_cutoff_ms)
+            , double_click_timeout_ms(double_click_timeout_ms)
+            , min_debounce_ms(min_debounce_ms)
+            , min_double_click_timeout_ms(min_double_click_timeout_ms)
+            , flags(flags)
+            , gestures(gestures)
+            , hold_stage_ms{ hold_stage_1_ms, hold_stage_2_ms, hold_stage_3_ms }
+            , release_debounce_ms(release_debounce_ms)
+        { }
+
+        uint32_t debounce_ms;
+        uint32_t clicked_cutoff_ms;
+        uint32_t double_click_timeout_ms;
+
+        // When less than debounce_ms, each button learns its debounce period
+        // from the bounce it observes, staying between this and debounce_ms.
+        uint32_t min_debounce_ms;
+
+        // When less than double_click_timeout_ms, each button learns its
+        // double click timeout from the user's click cadence, staying between
+        // this and double_click_timeout_ms.
+        uint32_t min_double_click_timeout_ms;
+
+        // Combination of the ProfileFlags below.
+        uint8_t flags;
+
+        // Combination of the Gestures below that may be recognized.
+        uint8_t gestures;
+
+        // The HOLD_STAGE_ inputs are delivered when a long press has lasted
+        // this long since it began. Stages must be increasing and longer than
+        // the click cutoff, and 0 disables a stage and those after it.
+        uint32_t hold_stage_ms[HOLD_STAGES];
+
+        // The debounce period for releases, which is never longer than the
+        // period for presses. Contacts bounce mostly on make, so this can
+        // usually be much shorter than debounce_ms.
+        uint32_t release_debounce_ms;
+    };
+
+    enum ProfileFlags {
+        // Deliver a provisional CLICK as soon as a click is released, then
+        // CLICK_CONFIRMED once the double click timeout expires, or
+        // CLICK_UPGRADED_TO_DOUBLE (instead of DOUBLE_CLICK) as soon as a
+        // second click is released. A CLICK_AND_LONG_PRESS also supersedes
+        // the provisional CLICK. When the gestures mask leaves a click
+        // nothing to resolve against, CLICK_CONFIRMED follows on the next
+        // update.
+        SPECULATIVE_CLICK = 0x01,
+    };
+
+    /**
+     * The gestures that may extend a click. Disabling gestures lets clicks be
+     * delivered without waiting to see whether they will be extended: a click
+     * is delivered as soon as it is released when neither GESTURE_DOUBLE_CLICK
+     * nor GESTURE_CLICK_AND_LONG_PRESS is enabled, and a double click when
+     * GESTURE_DOUBLE_CLICK_AND_LONG_PRESS is not.
+     */
+    enum Gestures {
+        GESTURE_DOUBLE_CLICK = 0x01,
+        GESTURE_CLICK_AND_LONG_PRESS = 0x02,
+        GESTURE_DOUBLE_CLICK_AND_LONG_PRESS = 0x04,
+        ALL_GESTURES = 0x07,
+    };
+
+    static const uint8_t MAX_PROFILES = DEBOUNCED_BUTTON_MAX_PROFILES;
+
+    /**
+     * An Input along with when the gesture it describes happened.
+     *
+     * The start time is when the gesture's first press was debounced, and
+     * the end time is when its last release was debounced or, for inputs
+     * delivered while the button is held, when the hold reached the relevant
+     * threshold. RELEASE and HOLD_STAGE_ inputs describe only the held press.
+     */
+    struct Event {
+        Input input;
+        uint8_t presses;
+        uint32_t start_tm;
+        uint32_t end_tm;
+    };
+
 private:
     /**
      * The state values that end in _PENDING indicate ones for which no Input
      * has yet been delivered.
      */
-    enum State {
+    enum State : uint8_t {
         IDLE,
         PRESSED,
         PRESSED_PENDING,
@@ -69,27 +185,107 @@ private:
         CLICKED_PRESSED_PENDING,
         DOUBLE_CLICKED_PENDING,
         DOUBLE_CLICKED_PRESSED_PENDING,
+        // IDLE and CLICKED_PENDING, with a CLICK_CONFIRMED or CLICK to
+        // deliver on the next update.
+        CLICK_CONFIRMED_PENDING,
+        CLICK_DEFERRED_PENDING,
     };
 
+    static Profile _profiles[MAX_PROFILES];
+
+    // Byte-sized fields are kept together so they share one word.
     bool _pressed_state;
     State _state = IDLE;
     bool _prev_reading = false;
     bool _debounced_reading = false;
+    uint8_t _profile_index;
+    uint8_t _bounce_ms = 0;
+    bool _clicked = false;
+    uint8_t _hold_stage = 0;
+    uint16_t _debounce_ms = UINT16_MAX;
+    uint16_t _double_click_ms = UINT16_MAX;
+    uint16_t _click_gap_avg = 0;
+    uint16_t _click_gap_dev = 0;
     uint32_t _last_reading_change_tm = 0;
     uint32_t _last_change_tm = 0;
     uint32_t _prev_last_change_tm = 0;
+    uint32_t _gesture_start_tm = 0;
+
+    Input transition(Profile const& profile, bool reading, uint32_t tm);
+    uint32_t debounce_window(Profile const& profile) const;
+    uint32_t pending_window(Profile const& profile) const;
+    uint32_t double_click_timeout(Profile const& profile) const;
+    void observe_bounce(Profile const& profile, uint32_t tm);
+    void learn_debounce_window(Profile const& profile);
+    void observe_click_gap(uint32_t gap);
+    void shrink_double_click_timeout(Profile const& profile);
 
 public:
     /**
-     * Creates a new instance with the specified polarity.
+     * Creates a new instance with the specified polarity that uses the timing
+     * profile at profile_index.
+     */
+    DebouncedButton(bool pressed_state = true, uint8_t profile_index = 0);
+
+    /**
+     * Replaces the timing profile at index. Out of range indexes are ignored.
+     */
+    static void set_profile(uint8_t index, Profile const& profile);
+
+    /**
+     * Returns the timing profile at index, which must be less than
+     * MAX_PROFILES.
+     */
+    static Profile const& profile(uint8_t index) { return _profiles[index]; }
+
+    /**
+     * Restores every entry in the profile table to the default timing.
      */
-    DebouncedButton(bool pressed_state = true);
+    static void reset_profiles();
+
+    /**
+     * Selects the timing profile used by this button. Out of range indexes
+     * are ignored.
+     */
+    void set_profile_index(uint8_t index);
+
+    /**
+     * Returns the index of the timing profile used by this button.
+     */
+    uint8_t profile_index() const { return _profile_index; }
 
     /**
      * Adds a reading to the button, and returns any recognized Input.
      */
     Input update(bool reading, uint32_t tm);
 
+    /**
+     * Adds a reading to the button like update(), and returns any recognized
+     * Input as an Event with its timing and number of presses.
+     */
+    Event update_event(bool reading, uint32_t tm);
+
+    /**
+     * Adds a reading that has already been debounced elsewhere, true for
+     * pressed regardless of the button's polarity, and returns any
+     * recognized Input. Used by debouncing front ends that handle many
+     * buttons at once.
+     */
+    Input update_debounced(bool pressed, uint32_t tm);
+
+    /**
+     * Returns the number of milliseconds a reading must be stable to change
+     * the debounced state, which varies when adaptive debouncing is enabled.
+     * Releases use the profile's release_debounce_ms instead when shorter.
+     */
+    uint32_t debounce_window() const { return debounce_window(_profiles[_profile_index]); }
+
+    /**
+     * Returns the number of milliseconds after a click that a second press
+     * makes a double click, which varies when adaptive timing is enabled.
+     */
+    uint32_t double_click_timeout() const { return double_click_timeout(_profiles[_profile_index]); }
+
     /**
      * Describes an input in human-readable terms.
      */
@@ -99,7 +295,13 @@ public:
      * Returns the debounced state of the button, true for pressed and
      * false otherwise.
      */
-    bool state() const { return _debounced_reading == _pressed_state; }
+    bool state() const { return _debounced_reading; }
+
+    /**
+     * Returns true if the latest reading differs from the debounced state,
+     * meaning the debounced state will change if the reading persists.
+     */
+    bool debouncing() const { return _prev_reading != _debounced_reading; }
 
     /**
      * Returns true if the button has had some kind of activity that will
@@ -108,15 +310,54 @@ public:
     bool input_pending() const;
 
     /**
-     * Returns the number of milliseconds between tm and the last change in
-     * the debounced state, or 0 if tm is earlier than the last change time.
+     * Sets deadline_tm to the time at which update() will next deliver an
+     * Input or change state if the reading doesn't change, and returns true,
+     * or returns false if there is no such time. Until then, updates with an
+     * unchanged reading have nothing to do.
+     */
+    bool next_deadline(uint32_t& deadline_tm) const;
+
+    /**
+     * Returns the number of milliseconds from since_tm to tm, or 0 if tm is
+     * earlier. Times are millis() values that wrap around every 2^32 ms, so
+     * the difference is taken modulo 2^32 and differences of 2^31 or more
+     * mean tm is earlier. Suited to waits for deadlines that may already
+     * have passed; durations use the plain modular difference instead.
+     */
+    static uint32_t elapsed(uint32_t since_tm, uint32_t tm)
+    {
+        uint32_t diff = tm - since_tm;
+        return diff & (uint32_t(int32_t(diff) < 0) - 1);
+    }
+
+    /**
+     * Returns true if tm is at or after deadline_tm, allowing for wraparound
+     * as elapsed() does.
      */
-    uint32_t duration(uint32_t tm) const { return max(uint32_t(0), tm - _last_change_tm); }
+    static bool reached(uint32_t deadline_tm, uint32_t tm) { return int32_t(tm - deadline_tm) >= 0; }
+
+    /**
+     * Returns the number of milliseconds from the last change in the debounced
+     * state to tm, modulo 2^32 like prev_duration(), so any idle period up to
+     * the full millis() range is reported.
+     */
+    uint32_t duration(uint32_t tm) const { return tm - _last_change_tm; }
+
+    /**
+     * Returns the time of the last change in the debounced state.
+     */
+    uint32_t last_change_tm() const { return _last_change_tm; }
 
     /**
      * Returns the number of milliseconds the button was in its previous state.
      */
-    uint32_t prev_duration(uint32_t tm) const { return _last_change_tm - _prev_last_change_tm; }
+    uint32_t prev_duration() const { return _last_change_tm - _prev_last_change_tm; }
+
+    /**
+     * Same as prev_duration(); tm is not used and is accepted for
+     * compatibility.
+     */
+    uint32_t prev_duration(uint32_t) const { return prev_duration(); }
 
     /**
      * Resets the state change timestamps of the button, effectively meaning
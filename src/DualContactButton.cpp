@@ -0,0 +1,44 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "DualContactButton.h"
+
+/*-------------------------------------------------------------------------*/
+
+DualContactButton::DualContactButton(bool closed_state, uint8_t profile_index)
+    : _button(true, profile_index)
+    , _closed_state(closed_state)
+{ }
+
+DebouncedButton::Input
+DualContactButton::update(bool no_reading, bool nc_reading, uint32_t tm)
+{
+    bool no_made = no_reading == _closed_state;
+    bool nc_made = nc_reading == _closed_state;
+
+    // Both contacts open is the gap while the switch travels, and both made
+    // can't happen on a working switch, so neither moves the latch.
+    if (no_made != nc_made)
+        _latched = no_made;
+
+    return _button.update_debounced(_latched, tm);
+}
+
+/*-------------------------------------------------------------------------*/
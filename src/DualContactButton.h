@@ -0,0 +1,113 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef dual_contact_button_h
+#define dual_contact_button_h
+
+#include "ButtonBank.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A button with both normally-open and normally-closed contacts wired, as on
+ * a break-before-make SPDT switch, debounced as an SR latch. The first make of
+ * the normally-open contact is a press and the first make of the
+ * normally-closed contact is a release. Bounces of a contact only break and
+ * remake the contact already made, which leaves the latch alone, so changes
+ * are recognized without waiting out a debounce period.
+ */
+class DualContactButton
+{
+    DebouncedButton _button;
+    bool _closed_state;
+    bool _latched = false;
+
+public:
+    /**
+     * Creates a new instance whose contacts read closed_state when made.
+     */
+    DualContactButton(bool closed_state = true, uint8_t profile_index = 0);
+
+    /**
+     * Adds readings of both contacts to the button, and returns any
+     * recognized Input.
+     */
+    DebouncedButton::Input update(bool no_reading, bool nc_reading, uint32_t tm);
+
+    DebouncedButton& button() { return _button; }
+    DebouncedButton const& button() const { return _button; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A DualContactButton for each bit of a pair of words, one with the
+ * normally-open contacts and one with the normally-closed contacts, latched
+ * together with a few bitwise operations.
+ */
+template <typename Word>
+class DualContactBank
+{
+public:
+    static const uint8_t SIZE = ButtonBank<Word>::SIZE;
+
+private:
+    Word _invert;
+    ButtonBank<Word> _bank;
+
+public:
+    /**
+     * Creates a new instance with the specified polarity, which has a bit set
+     * for each input whose contacts read 1 when made.
+     */
+    DualContactBank(Word closed_state = Word(~Word(0)))
+        : _invert(~closed_state)
+    { }
+
+    /**
+     * Adds readings of both contacts of every button, calling
+     * on_input(index, input) for each recognized Input.
+     */
+    template <typename F>
+    void update(Word no_readings, Word nc_readings, uint32_t tm, F&& on_input)
+    {
+        Word set = no_readings ^ _invert;
+        Word reset = nc_readings ^ _invert;
+        Word latched = (_bank.state() | (set & ~reset)) & ~(reset & ~set);
+        _bank.update(latched, tm, on_input);
+    }
+
+    /**
+     * Returns a mask of the buttons whose latched state is pressed.
+     */
+    Word state() const { return _bank.state(); }
+
+    // Bulk queries, as for ButtonBank.
+    Word pressed_mask() const { return _bank.pressed_mask(); }
+    Word pending_mask() const { return _bank.pending_mask(); }
+    Word changed_since(uint32_t tm) const { return _bank.changed_since(tm); }
+
+    DebouncedButton& button(uint8_t index) { return _bank.button(index); }
+    DebouncedButton const& button(uint8_t index) const { return _bank.button(index); }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
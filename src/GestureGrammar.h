@@ -0,0 +1,229 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef gesture_grammar_h
+#define gesture_grammar_h
+
+#include "DebouncedButton.h"
+
+#include <cstddef>
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A set of gestures compiled into a state transition table. Each gesture is
+ * written as a sequence of short ('.') and long ('-') presses, with '|'
+ * separating alternative sequences for the same gesture, and is identified
+ * by its position in the list of patterns plus one. Node 0 is the start
+ * state, and a transition to node 0 means the sequence can't continue.
+ *
+ * Tables are built at compile time by compile_gestures, and require C++14.
+ */
+
+/**
+ * Called by compile_gestures for a pattern containing a character other than
+ * '.', '-', or '|', or an empty sequence. It is not constexpr, so reaching it
+ * while compiling a constexpr table is a compile error naming it.
+ */
+inline void invalid_gesture_pattern() { }
+
+template <uint8_t MAX_NODES>
+struct GestureTable
+{
+    enum Symbol {
+        SHORT,
+        LONG,
+    };
+
+    uint8_t next[MAX_NODES][2] = {};
+    uint8_t gesture[MAX_NODES] = {};
+    uint8_t size = 1;
+
+    constexpr bool is_leaf(uint8_t node) const
+    {
+        return next[node][SHORT] == 0 && next[node][LONG] == 0;
+    }
+};
+
+/**
+ * Compiles the patterns into a minimal table. Patterns that share a prefix
+ * share its states, and states from which the same continuations lead to the
+ * same gestures are merged. A MAX_NODES too small for the patterns, an empty
+ * pattern or alternative, or any character other than '.', '-', and '|' is
+ * a compile error when the result is constexpr.
+ */
+template <uint8_t MAX_NODES, size_t N>
+constexpr GestureTable<MAX_NODES>
+compile_gestures(char const* const (&patterns)[N])
+{
+    using Table = GestureTable<MAX_NODES>;
+
+    // Build a trie of the patterns. Every node is created after its parent.
+    Table trie;
+    for (size_t i = 0; i < N; ++i) {
+        uint8_t node = 0;
+        for (char const* p = patterns[i]; ; ++p) {
+            if (*p == '|' || *p == '\0') {
+                if (node == 0)
+                    invalid_gesture_pattern();
+                trie.gesture[node] = i + 1;
+                if (*p == '\0')
+                    break;
+                node = 0;
+                continue;
+            }
+            if (*p != '.' && *p != '-')
+                invalid_gesture_pattern();
+            uint8_t symbol = *p == '-' ? Table::LONG : Table::SHORT;
+            if (!trie.next[node][symbol])
+                trie.next[node][symbol] = trie.size++;
+            node = trie.next[node][symbol];
+        }
+    }
+
+    // Working from the leaves up, map each node to an equivalent node
+    // already seen, if any.
+    uint8_t rep[MAX_NODES] = {};
+    for (int node = trie.size - 1; node > 0; --node) {
+        rep[node] = node;
+        uint8_t short_next = rep[trie.next[node][Table::SHORT]];
+        uint8_t long_next = rep[trie.next[node][Table::LONG]];
+        for (int other = node + 1; other < trie.size; ++other) {
+            if (rep[other] == other
+                && trie.gesture[other] == trie.gesture[node]
+                && rep[trie.next[other][Table::SHORT]] == short_next
+                && rep[trie.next[other][Table::LONG]] == long_next) {
+                rep[node] = other;
+                break;
+            }
+        }
+    }
+
+    // Number the remaining nodes in their original order.
+    uint8_t index[MAX_NODES] = {};
+    Table table;
+    for (int node = 1; node < trie.size; ++node)
+        if (rep[node] == node)
+            index[node] = table.size++;
+
+    for (int node = 0; node < trie.size; ++node) {
+        if (node && rep[node] != node)
+            continue;
+        uint8_t to = index[node];
+        table.next[to][Table::SHORT] = index[rep[trie.next[node][Table::SHORT]]];
+        table.next[to][Table::LONG] = index[rep[trie.next[node][Table::LONG]]];
+        table.gesture[to] = trie.gesture[node];
+    }
+
+    return table;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Recognizes the gestures in a GestureTable from the debounced state of a
+ * DebouncedButton. Presses shorter than the button's click cutoff are short,
+ * and a press becomes long as soon as it reaches the cutoff. A gesture is
+ * delivered when the button stays released for its double click timeout, or
+ * immediately if no pattern extends it.
+ *
+ * The matcher runs on top of the button's built-in state machine, which keeps
+ * running in update(), so it adds its own per-update cost rather than
+ * replacing that of the built-in gestures.
+ */
+template <uint8_t MAX_NODES>
+class GestureMatcher
+{
+    using Table = GestureTable<MAX_NODES>;
+
+    Table const& _table;
+    uint8_t _node = 0;
+    bool _pressed = false;
+    bool _long = false;
+
+    uint8_t step(uint8_t symbol)
+    {
+        uint8_t gesture = 0;
+        uint8_t next = _table.next[_node][symbol];
+        if (!next) {
+            // No pattern continues this way, so deliver what has been
+            // matched so far and start over with this press.
+            gesture = _table.gesture[_node];
+            next = _table.next[0][symbol];
+        }
+        _node = next;
+        return gesture;
+    }
+
+public:
+    /**
+     * Creates a new instance that matches the gestures in table, which must
+     * outlive it.
+     */
+    GestureMatcher(Table const& table)
+        : _table(table)
+    { }
+
+    /**
+     * Follows the debounced state of the button, which must already have
+     * been updated at tm, and returns the number of any recognized gesture
+     * or 0 for none. Must be called after every update of the button.
+     */
+    uint8_t update(DebouncedButton const& button, uint32_t tm)
+    {
+        uint8_t gesture = 0;
+        bool pressed = button.state();
+
+        if (pressed != _pressed) {
+            _pressed = pressed;
+            if (pressed)
+                _long = false;
+            else if (!_long)
+                gesture = step(Table::SHORT);
+        } else if (button.debouncing()) {
+            // Like DebouncedButton, wait to see whether the reading change
+            // becomes the next press or release before timing out.
+        } else if (pressed) {
+            if (!_long && button.duration(tm) >= DebouncedButton::profile(button.profile_index()).clicked_cutoff_ms) {
+                _long = true;
+                gesture = step(Table::LONG);
+            }
+        } else if (_node && button.duration(tm) > button.double_click_timeout()) {
+            gesture = _table.gesture[_node];
+            _node = 0;
+        }
+
+        // Nothing can extend a leaf, so there is no need to wait.
+        if (!gesture && _node && _table.is_leaf(_node)) {
+            gesture = _table.gesture[_node];
+            _node = 0;
+        }
+
+        return gesture;
+    }
+
+    /**
+     * Returns true if a gesture has been started but not yet delivered.
+     */
+    bool gesture_pending() const { return _node != 0; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
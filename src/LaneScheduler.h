@@ -0,0 +1,117 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef lane_scheduler_h
+#define lane_scheduler_h
+
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Runs the scans of LANES groups of inputs, each at its own period, so that
+ * critical inputs such as an emergency stop can be scanned every millisecond
+ * while panel buttons are scanned every 10. Lanes are scanned in order when
+ * due together, so lane 0 should be the most critical. Each lane records how
+ * late its scans ran, and scans missed entirely are skipped, not made up.
+ *
+ * Every scan is passed the actual time, so the millisecond timing of the
+ * buttons it updates is unaffected by the lane's period. Debouncers that
+ * count samples instead, like VerticalCounter, need their counts sized for
+ * the period; see counter_bits_for().
+ */
+template <uint8_t LANES>
+class LaneScheduler
+{
+public:
+    struct LaneStats {
+        uint32_t scans;
+        uint32_t missed;
+        uint32_t last_jitter_ms;
+        uint32_t max_jitter_ms;
+    };
+
+private:
+    uint32_t _period_ms[LANES];
+    uint32_t _next_tm[LANES];
+    LaneStats _stats[LANES] = {};
+
+public:
+    /**
+     * Creates a new instance with the specified lane periods, whose first
+     * scans are due at start_tm.
+     */
+    LaneScheduler(uint32_t const (&period_ms)[LANES], uint32_t start_tm = 0)
+    {
+        for (uint8_t lane = 0; lane < LANES; ++lane) {
+            _period_ms[lane] = period_ms[lane] ? period_ms[lane] : 1;
+            _next_tm[lane] = start_tm;
+        }
+    }
+
+    /**
+     * Calls scan(lane, tm) for each lane whose scan is due at tm.
+     */
+    template <typename F>
+    void update(uint32_t tm, F&& scan)
+    {
+        for (uint8_t lane = 0; lane < LANES; ++lane) {
+            if (!DebouncedButton::reached(_next_tm[lane], tm))
+                continue;
+
+            uint32_t jitter_ms = DebouncedButton::elapsed(_next_tm[lane], tm);
+            uint32_t missed = jitter_ms / _period_ms[lane];
+            _next_tm[lane] += (missed + 1) * _period_ms[lane];
+
+            LaneStats& stats = _stats[lane];
+            ++stats.scans;
+            stats.missed += missed;
+            stats.last_jitter_ms = jitter_ms;
+            if (jitter_ms > stats.max_jitter_ms)
+                stats.max_jitter_ms = jitter_ms;
+
+            scan(lane, tm);
+        }
+    }
+
+    /**
+     * Sets deadline_tm to when the next scan of any lane is due.
+     */
+    void next_deadline(uint32_t& deadline_tm) const
+    {
+        deadline_tm = _next_tm[0];
+        for (uint8_t lane = 1; lane < LANES; ++lane)
+            if (int32_t(_next_tm[lane] - deadline_tm) < 0)
+                deadline_tm = _next_tm[lane];
+    }
+
+    uint32_t period_ms(uint8_t lane) const { return _period_ms[lane]; }
+
+    /**
+     * Returns the scan count, missed scans and lateness of the lane since it
+     * was created or its stats were last reset.
+     */
+    LaneStats const& stats(uint8_t lane) const { return _stats[lane]; }
+    void reset_stats(uint8_t lane) { _stats[lane] = LaneStats(); }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
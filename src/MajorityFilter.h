@@ -0,0 +1,81 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef majority_filter_h
+#define majority_filter_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Returns the level indicated by a word of oversampled readings of one input,
+ * true if at least threshold of the samples are set.
+ */
+template <typename Word>
+inline bool majority_level(Word samples, uint8_t threshold)
+{
+    return popcount(samples) >= threshold;
+}
+
+/**
+ * A DebouncedButton fed by oversampled readings. Each update takes a word
+ * holding one bit per sample, and the button sees the majority level of the
+ * word, so short spikes never reach it as reading changes and never restart
+ * its debounce period. Because of that, a profile with a shorter debounce
+ * period is often sufficient.
+ */
+template <typename Word>
+class OversampledButton
+{
+public:
+    static const uint8_t SAMPLES = sizeof(Word) * 8;
+
+private:
+    DebouncedButton _button;
+    uint8_t _threshold;
+
+public:
+    /**
+     * Creates a new instance with the specified polarity, which considers the
+     * input high when at least threshold of the samples are set. The default
+     * threshold is a strict majority of the samples in a Word.
+     */
+    OversampledButton(bool pressed_state = true, uint8_t threshold = SAMPLES / 2 + 1, uint8_t profile_index = 0)
+        : _button(pressed_state, profile_index)
+        , _threshold(threshold)
+    { }
+
+    /**
+     * Adds a word of samples to the button, and returns any recognized Input.
+     */
+    DebouncedButton::Input update(Word samples, uint32_t tm)
+    {
+        return _button.update(majority_level(samples, _threshold), tm);
+    }
+
+    DebouncedButton& button() { return _button; }
+    DebouncedButton const& button() const { return _button; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
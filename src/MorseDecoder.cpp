@@ -0,0 +1,97 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "MorseDecoder.h"
+
+/*-------------------------------------------------------------------------*/
+
+namespace {
+
+// Letters and digits of up to five elements, in tree order starting from the
+// empty sequence at index 1.
+const char MORSE_TREE[] =
+    "??ETIANMSURWDKGOHVF?L?PJBXCYZQ??54?3???2???????16???????7???8?90";
+
+const uint8_t ROOT = 1;
+const uint8_t TREE_SIZE = sizeof(MORSE_TREE) - 1;
+
+} // anonymous namespace
+
+const uint32_t MorseDecoder::DASH_MS;
+const uint32_t MorseDecoder::LETTER_GAP_MS;
+const uint32_t MorseDecoder::WORD_GAP_MS;
+
+MorseDecoder::MorseDecoder(uint32_t dash_ms, uint32_t letter_gap_ms, uint32_t word_gap_ms)
+    : _dash_ms(dash_ms)
+    , _letter_gap_ms(letter_gap_ms)
+    , _word_gap_ms(word_gap_ms)
+    , _node(ROOT)
+{ }
+
+char
+MorseDecoder::update(DebouncedButton const& button, uint32_t tm)
+{
+    bool pressed = button.state();
+
+    if (pressed != _pressed) {
+        _pressed = pressed;
+        if (!pressed) {
+            // Sequences too long for the tree stay past its end until the
+            // symbol is finished.
+            bool dash = button.prev_duration() >= _dash_ms;
+            if (_node < TREE_SIZE)
+                _node = 2 * _node + dash;
+        }
+        return 0;
+    }
+
+    if (pressed || button.debouncing())
+        return 0;
+
+    uint32_t gap = button.duration(tm);
+
+    if (_node != ROOT && gap >= _letter_gap_ms) {
+        char symbol = _node < TREE_SIZE ? MORSE_TREE[_node] : '?';
+        _node = ROOT;
+        _word_pending = true;
+        return symbol;
+    }
+
+    if (_word_pending && gap >= _word_gap_ms) {
+        _word_pending = false;
+        return ' ';
+    }
+
+    return 0;
+}
+
+bool
+MorseDecoder::symbol_pending() const
+{
+    return _node != ROOT;
+}
+
+void
+MorseDecoder::reset()
+{
+    _node = ROOT;
+    _word_pending = false;
+}
+
+/*-------------------------------------------------------------------------*/
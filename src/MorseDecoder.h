@@ -0,0 +1,83 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef morse_decoder_h
+#define morse_decoder_h
+
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Decodes Morse code tapped on a DebouncedButton into letters and digits.
+ *
+ * The code tree is stored as an array in which the node for a sequence at
+ * index i is followed by a dot at 2i and a dash at 2i + 1, so the decoder's
+ * only state is its position in the tree.
+ */
+class MorseDecoder
+{
+public:
+    // A press at least this long is a dash, and a shorter one is a dot.
+    static const uint32_t DASH_MS = DebouncedButton::CLICKED_CUTOFF_MS;
+
+    // A release at least this long ends the current symbol.
+    static const uint32_t LETTER_GAP_MS = 400;
+
+    // A release at least this long after a symbol ends the word.
+    static const uint32_t WORD_GAP_MS = 1200;
+
+private:
+    uint32_t _dash_ms;
+    uint32_t _letter_gap_ms;
+    uint32_t _word_gap_ms;
+    uint8_t _node;
+    bool _pressed = false;
+    bool _word_pending = false;
+
+public:
+    /**
+     * Creates a new instance with the specified timing.
+     */
+    MorseDecoder(uint32_t dash_ms = DASH_MS,
+                 uint32_t letter_gap_ms = LETTER_GAP_MS,
+                 uint32_t word_gap_ms = WORD_GAP_MS);
+
+    /**
+     * Follows the debounced state of the button, which must already have
+     * been updated at tm, and returns a decoded letter or digit, '?' for an
+     * unknown sequence, ' ' at the end of a word, or 0 for nothing. Must be
+     * called after every update of the button.
+     */
+    char update(DebouncedButton const& button, uint32_t tm);
+
+    /**
+     * Returns true if dots or dashes have been entered but not yet decoded.
+     */
+    bool symbol_pending() const;
+
+    /**
+     * Discards any partially entered symbol.
+     */
+    void reset();
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,77 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "ScanRateController.h"
+
+/*-------------------------------------------------------------------------*/
+
+const uint32_t ScanRateController::IDLE_PERIOD_MS;
+const uint32_t ScanRateController::ACTIVE_PERIOD_MS;
+
+ScanRateController::ScanRateController(uint32_t idle_period_ms, uint32_t active_period_ms)
+    : _idle_period_ms(idle_period_ms)
+    , _active_period_ms(active_period_ms ? active_period_ms : 1)
+{
+    if (_idle_period_ms < _active_period_ms)
+        _idle_period_ms = _active_period_ms;
+}
+
+void
+ScanRateController::begin_scan()
+{
+    _active = false;
+    _has_deadline = false;
+}
+
+void
+ScanRateController::observe(DebouncedButton const& button)
+{
+    if (button.state() || button.debouncing() || button.input_pending())
+        _active = true;
+
+    uint32_t deadline_tm;
+    if (button.next_deadline(deadline_tm)
+        && (!_has_deadline || int32_t(deadline_tm - _deadline_tm) < 0)) {
+        _deadline_tm = deadline_tm;
+        _has_deadline = true;
+    }
+}
+
+void
+ScanRateController::end_scan(uint32_t tm)
+{
+    uint32_t period_ms = _active ? _active_period_ms : _idle_period_ms;
+
+    // An idle button with a deadline, like a speculative click awaiting
+    // confirmation, still gets its deadline met.
+    if (!_active && _has_deadline) {
+        uint32_t wait_ms = DebouncedButton::elapsed(tm, _deadline_tm);
+        if (wait_ms < _active_period_ms)
+            wait_ms = _active_period_ms;
+        if (wait_ms < period_ms)
+            period_ms = wait_ms;
+    }
+
+    ++_scans;
+    _scans_saved += period_ms / _active_period_ms - 1;
+    _next_scan_tm = tm + period_ms;
+}
+
+/*-------------------------------------------------------------------------*/
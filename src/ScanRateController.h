@@ -0,0 +1,114 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef scan_rate_controller_h
+#define scan_rate_controller_h
+
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Chooses when to scan a set of buttons next: at the active period while any
+ * of them is pressed, debouncing, or has an Input pending, and otherwise at
+ * the idle period, or sooner if a button has an earlier deadline. The first
+ * edge of a press from idle is therefore seen within the idle period, after
+ * which scanning is fast until the gesture is over.
+ *
+ * Each scan calls begin_scan(), then observe() after updating each button,
+ * then end_scan(), and the next scan is due at next_scan_tm().
+ */
+class ScanRateController
+{
+public:
+    static const uint32_t IDLE_PERIOD_MS = 50;
+    static const uint32_t ACTIVE_PERIOD_MS = 1;
+
+private:
+    uint32_t _idle_period_ms;
+    uint32_t _active_period_ms;
+    uint32_t _next_scan_tm = 0;
+    uint32_t _deadline_tm = 0;
+    bool _active = false;
+    bool _has_deadline = false;
+    uint32_t _scans = 0;
+    uint32_t _scans_saved = 0;
+
+public:
+    /**
+     * Creates a new instance with the specified scan periods. An active
+     * period of 0 is taken as 1, and an idle period shorter than the active
+     * period is taken as the active period.
+     */
+    ScanRateController(uint32_t idle_period_ms = IDLE_PERIOD_MS,
+                       uint32_t active_period_ms = ACTIVE_PERIOD_MS);
+
+    /**
+     * Returns true if a scan is due at tm.
+     */
+    bool scan_due(uint32_t tm) const { return DebouncedButton::reached(_next_scan_tm, tm); }
+
+    /**
+     * Starts a scan.
+     */
+    void begin_scan();
+
+    /**
+     * Takes account of a button that has just been updated.
+     */
+    void observe(DebouncedButton const& button);
+
+    /**
+     * Finishes the scan made at tm, and chooses when the next is due.
+     */
+    void end_scan(uint32_t tm);
+
+    /**
+     * Makes the next scan due immediately, for example from a pin change
+     * interrupt.
+     */
+    void wake(uint32_t tm) { _next_scan_tm = tm; }
+
+    /**
+     * Returns the time the next scan is due.
+     */
+    uint32_t next_scan_tm() const { return _next_scan_tm; }
+
+    /**
+     * Returns true if the latest scan chose the active period.
+     */
+    bool active() const { return _active; }
+
+    /**
+     * Returns the longest a first edge from idle can wait to be seen.
+     */
+    uint32_t max_first_edge_latency_ms() const { return _idle_period_ms; }
+
+    /**
+     * Returns the number of scans made, and the number that scanning at the
+     * active period throughout would have added.
+     */
+    uint32_t scans() const { return _scans; }
+    uint32_t scans_saved() const { return _scans_saved; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
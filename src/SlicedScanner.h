@@ -0,0 +1,127 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef sliced_scanner_h
+#define sliced_scanner_h
+
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Scans a bank of SIZE buttons too large to read every tick. Each tick visits
+ * the next slice of the bank, so every button is visited at least once per
+ * sweep of the configured number of ticks. A button that's mid-gesture, with
+ * a reading being debounced or a timeout to wait for, moves to a priority
+ * lane of up to LANE buttons that are visited every tick until its gesture
+ * is resolved. A first edge is therefore seen within one sweep, and from then
+ * on the button is sampled at full rate.
+ */
+template <uint32_t SIZE, uint16_t LANE = 64>
+class SlicedScanner
+{
+    DebouncedButton _buttons[SIZE];
+    uint8_t _in_lane[(SIZE + 7) / 8] = {};
+    uint32_t _lane[LANE];
+    uint16_t _lane_size = 0;
+    uint32_t _slice;
+    uint32_t _cursor = 0;
+    uint32_t _lane_overflows = 0;
+
+    bool in_lane(uint32_t index) const { return (_in_lane[index / 8] >> (index % 8)) & 1; }
+
+    template <typename Read, typename F>
+    bool visit(uint32_t index, uint32_t tm, Read& read, F& on_input)
+    {
+        DebouncedButton& button = _buttons[index];
+        auto input = button.update(read(index), tm);
+        if (input != DebouncedButton::NONE)
+            on_input(index, input);
+
+        uint32_t deadline_tm;
+        return button.next_deadline(deadline_tm);
+    }
+
+public:
+    /**
+     * Creates a new instance that sweeps the whole bank every sweep_ticks
+     * ticks, with 0 taken as 1. A sweep must take no longer than the
+     * buttons' debounce window, so that every press long enough to be
+     * accepted is read at least once before it ends.
+     */
+    SlicedScanner(uint32_t sweep_ticks)
+        : _slice(sweep_ticks ? (SIZE + sweep_ticks - 1) / sweep_ticks : SIZE)
+    { }
+
+    /**
+     * Visits the priority lane and the next slice of the bank, reading
+     * button i with read(i) and calling on_input(index, input) for each
+     * recognized Input.
+     */
+    template <typename Read, typename F>
+    void update(uint32_t tm, Read&& read, F&& on_input)
+    {
+        // Backwards, so a resolved button can be replaced by the last one.
+        for (uint16_t k = _lane_size; k-- > 0; ) {
+            uint32_t index = _lane[k];
+            if (!visit(index, tm, read, on_input)) {
+                _in_lane[index / 8] &= ~(1 << (index % 8));
+                _lane[k] = _lane[--_lane_size];
+            }
+        }
+
+        for (uint32_t n = 0; n < _slice; ++n) {
+            uint32_t index = _cursor;
+            _cursor = _cursor + 1 < SIZE ? _cursor + 1 : 0;
+            if (in_lane(index) || !visit(index, tm, read, on_input))
+                continue;
+
+            if (_lane_size < LANE) {
+                _in_lane[index / 8] |= 1 << (index % 8);
+                _lane[_lane_size++] = index;
+            } else {
+                // The button stays on the slower sweep.
+                ++_lane_overflows;
+            }
+        }
+    }
+
+    /**
+     * Returns the number of buttons visited per tick outside the lane.
+     */
+    uint32_t slice() const { return _slice; }
+
+    /**
+     * Returns the number of buttons in the priority lane.
+     */
+    uint16_t lane_size() const { return _lane_size; }
+
+    /**
+     * Returns the number of times a mid-gesture button found the lane full.
+     */
+    uint32_t lane_overflows() const { return _lane_overflows; }
+
+    DebouncedButton& button(uint32_t index) { return _buttons[index]; }
+    DebouncedButton const& button(uint32_t index) const { return _buttons[index]; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
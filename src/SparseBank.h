@@ -0,0 +1,201 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef sparse_bank_h
+#define sparse_bank_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A bank of SIZE buttons in which few are active at a time, such as the
+ * inputs of a large test fixture. Readings are stored as they arrive, and a
+ * two-level bitmap marks the buttons that need visiting: a bit per button
+ * whose reading changed or that is waiting on a deadline, and a bit per word
+ * of those with any set. Each tick finds the active buttons by counting
+ * trailing zeros, so it costs O(active + SIZE / 4096).
+ */
+template <uint32_t SIZE>
+class SparseBank
+{
+public:
+    static const uint32_t WORDS = (SIZE + 63) / 64;
+    static const uint32_t SUMMARY_WORDS = (WORDS + 63) / 64;
+
+    // Changes older than this are forgotten by changed_since().
+    static const uint32_t CHANGE_HORIZON_MS = uint32_t(1) << 30;
+
+private:
+    uint64_t _readings[WORDS] = {};
+    uint64_t _active[WORDS] = {};
+    uint64_t _summary[SUMMARY_WORDS] = {};
+    uint64_t _pressed[WORDS] = {};
+    uint64_t _pending[WORDS] = {};
+    uint64_t _changed[WORDS] = {};
+    uint32_t _change_tm[WORDS] = {};
+    uint32_t _prune_tm = 0;
+    bool _has_changes = false;
+    DebouncedButton _buttons[SIZE];
+
+    void mark(uint32_t index)
+    {
+        _active[index / 64] |= uint64_t(1) << (index % 64);
+        _summary[index / 4096] |= uint64_t(1) << (index / 64 % 64);
+    }
+
+public:
+    /**
+     * Stores the latest reading of a button, to be processed by the next
+     * update.
+     */
+    void set_reading(uint32_t index, bool reading)
+    {
+        uint64_t bit = uint64_t(1) << (index % 64);
+        if (bool(_readings[index / 64] & bit) == reading)
+            return;
+        _readings[index / 64] ^= bit;
+        mark(index);
+    }
+
+    bool reading(uint32_t index) const { return (_readings[index / 64] >> (index % 64)) & 1; }
+
+    /**
+     * Updates the buttons whose reading changed or that are waiting on a
+     * deadline, calling on_input(index, input) for each recognized Input.
+     */
+    template <typename F>
+    void update(uint32_t tm, F&& on_input)
+    {
+        for (uint32_t s = 0; s < SUMMARY_WORDS; ++s) {
+            for_each_bit(_summary[s], [&](uint8_t j) {
+                uint32_t w = s * 64 + j;
+                for_each_bit(_active[w], [&](uint8_t i) {
+                    uint32_t index = w * 64 + i;
+                    DebouncedButton& button = _buttons[index];
+
+                    auto input = button.update((_readings[w] >> i) & 1, tm);
+                    if (input != DebouncedButton::NONE)
+                        on_input(index, input);
+
+                    uint64_t bit = uint64_t(1) << i;
+                    if (button.state() != bool(_pressed[w] & bit)) {
+                        _pressed[w] ^= bit;
+                        _changed[w] |= bit;
+                        _change_tm[w] = tm;
+                        if (!_has_changes) {
+                            _has_changes = true;
+                            _prune_tm = tm + CHANGE_HORIZON_MS / 2;
+                        }
+                    }
+                    if (button.input_pending())
+                        _pending[w] |= bit;
+                    else
+                        _pending[w] &= ~bit;
+
+                    uint32_t deadline_tm;
+                    if (!button.next_deadline(deadline_tm))
+                        _active[w] &= ~bit;
+                });
+                if (!_active[w])
+                    _summary[s] &= ~(uint64_t(1) << j);
+            });
+        }
+
+        // Every half horizon, forget the changes older than the horizon, so
+        // that none is old enough to look recent after millis() wraps.
+        if (_has_changes && DebouncedButton::reached(_prune_tm, tm)) {
+            _has_changes = false;
+            for (uint32_t w = 0; w < WORDS; ++w) {
+                for_each_bit(_changed[w], [&](uint8_t i) {
+                    if (tm - _buttons[w * 64 + i].last_change_tm() >= CHANGE_HORIZON_MS)
+                        _changed[w] &= ~(uint64_t(1) << i);
+                });
+                if (_changed[w])
+                    _has_changes = true;
+            }
+            _prune_tm = tm + CHANGE_HORIZON_MS / 2;
+        }
+    }
+
+    /**
+     * Sets mask to a packed bitset of the buttons whose debounced state is
+     * pressed, bit i % 64 of word i / 64 for button i.
+     */
+    void pressed_mask(uint64_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w)
+            mask[w] = _pressed[w];
+    }
+
+    /**
+     * Sets mask to a packed bitset of the buttons with an Input pending.
+     */
+    void pending_mask(uint64_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w)
+            mask[w] = _pending[w];
+    }
+
+    /**
+     * Sets mask to a packed bitset of the buttons whose debounced state has
+     * changed at or after tm, which must be within CHANGE_HORIZON_MS of the
+     * latest update. Only words with such a change are examined button by
+     * button.
+     */
+    void changed_since(uint32_t tm, uint64_t (&mask)[WORDS]) const
+    {
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            mask[w] = 0;
+            if (!_changed[w] || !DebouncedButton::reached(tm, _change_tm[w]))
+                continue;
+            for_each_bit(_changed[w], [&](uint8_t i) {
+                if (DebouncedButton::reached(tm, _buttons[w * 64 + i].last_change_tm()))
+                    mask[w] |= uint64_t(1) << i;
+            });
+        }
+    }
+
+    /**
+     * Returns true if the button will be visited by the next update.
+     */
+    bool active(uint32_t index) const { return (_active[index / 64] >> (index % 64)) & 1; }
+
+    /**
+     * Returns true if no button needs visiting.
+     */
+    bool idle() const
+    {
+        for (uint32_t s = 0; s < SUMMARY_WORDS; ++s)
+            if (_summary[s])
+                return false;
+        return true;
+    }
+
+    DebouncedButton& button(uint32_t index) { return _buttons[index]; }
+    DebouncedButton const& button(uint32_t index) const { return _buttons[index]; }
+};
+
+template <uint32_t SIZE> const uint32_t SparseBank<SIZE>::CHANGE_HORIZON_MS;
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,118 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef split_bank_h
+#define split_bank_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A bank of SIZE buttons scanned from packed readings, laid out so the common
+ * case touches as little memory as possible. The hot data is two bit columns,
+ * the latest reading of every button and whether it is waiting on a
+ * deadline, so checking 64 idle buttons reads three words. The buttons
+ * themselves, with their timestamps, and the cached deadlines are cold: they
+ * are touched only for buttons whose reading changed or whose deadline has
+ * been reached.
+ */
+template <uint32_t SIZE>
+class SplitBank
+{
+public:
+    static const uint32_t WORDS = (SIZE + 63) / 64;
+
+private:
+    // Hot columns
+    uint64_t _readings[WORDS] = {};
+    uint64_t _timing[WORDS] = {};
+    uint32_t _next_deadline_tm = 0;
+    uint32_t _timing_words = 0;
+
+    // Cold columns
+    uint32_t _deadline_tm[SIZE];
+    DebouncedButton _buttons[SIZE];
+
+public:
+    /**
+     * Adds a reading of every button, bit i % 64 of word i / 64 for button
+     * i, calling on_input(index, input) for each recognized Input.
+     */
+    template <typename F>
+    void update(uint64_t const (&readings)[WORDS], uint32_t tm, F&& on_input)
+    {
+        bool deadlines_due = _timing_words && DebouncedButton::reached(_next_deadline_tm, tm);
+        bool deadlines_changed = false;
+
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            uint64_t due = readings[w] ^ _readings[w];
+            if (deadlines_due && _timing[w]) {
+                for_each_bit(_timing[w], [&](uint8_t i) {
+                    if (DebouncedButton::reached(_deadline_tm[w * 64 + i], tm))
+                        due |= uint64_t(1) << i;
+                });
+            }
+            if (!due)
+                continue;
+
+            _readings[w] = readings[w];
+            uint64_t was_timing = _timing[w];
+            for_each_bit(due, [&](uint8_t i) {
+                uint32_t index = w * 64 + i;
+                DebouncedButton& button = _buttons[index];
+
+                auto input = button.update((readings[w] >> i) & 1, tm);
+                if (input != DebouncedButton::NONE)
+                    on_input(index, input);
+
+                if (button.next_deadline(_deadline_tm[index]))
+                    _timing[w] |= uint64_t(1) << i;
+                else
+                    _timing[w] &= ~(uint64_t(1) << i);
+            });
+            _timing_words += (_timing[w] != 0) - (was_timing != 0);
+            deadlines_changed = true;
+        }
+
+        if (!deadlines_changed)
+            return;
+
+        // Find the earliest deadline again, by signed difference so as to
+        // stay correct across rollover.
+        bool first = true;
+        for (uint32_t w = 0; w < WORDS && _timing_words; ++w) {
+            for_each_bit(_timing[w], [&](uint8_t i) {
+                uint32_t deadline_tm = _deadline_tm[w * 64 + i];
+                if (first || int32_t(deadline_tm - _next_deadline_tm) < 0)
+                    _next_deadline_tm = deadline_tm;
+                first = false;
+            });
+        }
+    }
+
+    DebouncedButton& button(uint32_t index) { return _buttons[index]; }
+    DebouncedButton const& button(uint32_t index) const { return _buttons[index]; }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
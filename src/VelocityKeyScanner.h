@@ -0,0 +1,209 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef velocity_key_scanner_h
+#define velocity_key_scanner_h
+
+#include "BitOps.h"
+#include "DebouncedButton.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Scans KEYS keys that each have two staggered contacts, as on a velocity
+ * sensitive keyboard, and reports strikes with the velocity derived from the
+ * time between the first and second contact closing. Times are in whatever
+ * units the caller passes, microseconds for the default timing.
+ *
+ * A key is armed when its first contact closes, struck when its second
+ * contact closes while armed, and released when both contacts are open again.
+ * Bounces of the first contact don't restart the timing, and an armed key
+ * that opens without being struck is disarmed after the slowest measurable
+ * strike time. State is kept in bitmasks of 32 keys, so a scan in which no
+ * key changes costs a few bitwise operations per 32 keys.
+ */
+template <uint16_t KEYS>
+class VelocityKeyScanner
+{
+public:
+    static const uint32_t WORDS = (KEYS + 31) / 32;
+    static const uint8_t VELOCITY_STEPS = 64;
+
+    // The fastest strike, which has velocity 127, and the slowest, which has
+    // velocity 1.
+    static const uint32_t MIN_STRIKE_TM = 1000;
+    static const uint32_t MAX_STRIKE_TM = 100000;
+
+private:
+    uint32_t _min_strike_tm;
+    uint32_t _max_strike_tm;
+    uint16_t _min_log_step = 0;
+    uint8_t _step_bits;
+    bool _closed_state;
+    uint8_t _velocity[VELOCITY_STEPS];
+
+    uint32_t _armed[WORDS] = {};
+    uint32_t _down[WORDS] = {};
+    uint32_t _armed_tm[KEYS];
+
+public:
+    /**
+     * Creates a new instance whose contacts read closed_state when closed,
+     * with velocities following 1/t between the specified strike times.
+     */
+    VelocityKeyScanner(bool closed_state = true,
+                       uint32_t min_strike_tm = MIN_STRIKE_TM,
+                       uint32_t max_strike_tm = MAX_STRIKE_TM)
+        : _min_strike_tm(min_strike_tm)
+        , _max_strike_tm(max_strike_tm)
+        , _closed_state(closed_state)
+    {
+        // Use as many steps per octave as fit, so that the table resolves
+        // the fast strikes, where 1/t changes quickest, as well as slow ones.
+        uint32_t min_tm = min_strike_tm ? min_strike_tm : 1;
+        uint32_t max_tm = max_strike_tm > min_tm ? max_strike_tm : min_tm;
+        _step_bits = 5;
+        while (_step_bits && log_step(max_tm, _step_bits) - log_step(min_tm, _step_bits) >= VELOCITY_STEPS)
+            --_step_bits;
+        _min_log_step = log_step(min_tm, _step_bits);
+
+        // Each entry is the velocity at the middle of its step.
+        uint8_t last = step(max_tm);
+        uint32_t range = max_strike_tm - min_strike_tm;
+        for (uint8_t i = 0; i < VELOCITY_STEPS; ++i) {
+            uint64_t t = i <= last ? step_tm(i) : max_strike_tm;
+            if (t < min_strike_tm)
+                t = min_strike_tm;
+            if (t > max_strike_tm)
+                t = max_strike_tm;
+            _velocity[i] = t ? 1 + 126 * (max_strike_tm - t) * min_strike_tm / (t * (range ? range : 1)) : 127;
+        }
+    }
+
+    /**
+     * Returns the velocity of a strike taking strike_tm.
+     */
+    uint8_t velocity(uint32_t strike_tm) const
+    {
+        if (strike_tm <= _min_strike_tm)
+            return 127;
+        if (strike_tm >= _max_strike_tm)
+            return 1;
+        return _velocity[step(strike_tm)];
+    }
+
+    /**
+     * Returns the index into the velocity table for a strike taking
+     * strike_tm, which must be between the fastest and slowest strike times.
+     * Every octave of strike times is split into the same number of steps,
+     * so the steps are roughly even in log(strike_tm).
+     */
+    uint8_t step(uint32_t strike_tm) const { return log_step(strike_tm, _step_bits) - _min_log_step; }
+
+    /**
+     * Returns the strike time in the middle of the given step, for steps up
+     * to that of the slowest strike time.
+     */
+    uint32_t step_tm(uint8_t step) const
+    {
+        uint16_t log_step = _min_log_step + step;
+        uint8_t octave = log_step >> _step_bits;
+        uint32_t step_bit = uint32_t(1) << _step_bits;
+        uint64_t low = (uint64_t(step_bit | (log_step & (step_bit - 1))) << octave) >> _step_bits;
+        uint64_t width = (uint64_t(1) << octave) >> _step_bits;
+        return low + width / 2;
+    }
+
+    /**
+     * Returns the table of velocities, indexed by step(), which may be
+     * replaced for other curves.
+     */
+    uint8_t (&velocity_table())[VELOCITY_STEPS] { return _velocity; }
+
+    /**
+     * Adds readings of both contacts of every key, bit i % 32 of word i / 32
+     * for key i, calling on_key(key, velocity) when a key is struck and
+     * on_key(key, 0) when it is released.
+     */
+    template <typename F>
+    void update(uint32_t const (&first)[WORDS], uint32_t const (&second)[WORDS], uint32_t tm, F&& on_key)
+    {
+        uint32_t invert = _closed_state ? 0 : ~uint32_t(0);
+
+        for (uint32_t w = 0; w < WORDS; ++w) {
+            uint32_t first_closed = first[w] ^ invert;
+            uint32_t second_closed = second[w] ^ invert;
+            uint32_t open = ~(first_closed | second_closed);
+            uint32_t base = w * 32;
+
+            for_each_bit(uint32_t(first_closed & ~_armed[w] & ~_down[w]), [&](uint8_t i) {
+                _armed_tm[base + i] = tm;
+            });
+            _armed[w] |= first_closed & ~_down[w];
+
+            uint32_t struck = second_closed & _armed[w];
+            for_each_bit(struck, [&](uint8_t i) {
+                on_key(base + i, velocity(tm - _armed_tm[base + i]));
+            });
+            _armed[w] &= ~struck;
+            _down[w] |= struck;
+
+            uint32_t released = _down[w] & open;
+            for_each_bit(released, [&](uint8_t i) { on_key(base + i, 0); });
+            _down[w] &= ~released;
+
+            // Keys armed for longer than the slowest strike are disarmed if
+            // released, and otherwise stay armed at the slowest strike time,
+            // so the modular strike time can't wrap while a key rests on its
+            // first contact.
+            for_each_bit(_armed[w], [&](uint8_t i) {
+                if (tm - _armed_tm[base + i] >= _max_strike_tm) {
+                    if ((open >> i) & 1)
+                        _armed[w] &= ~(uint32_t(1) << i);
+                    else
+                        _armed_tm[base + i] = tm - _max_strike_tm;
+                }
+            });
+        }
+    }
+
+    /**
+     * Returns true if the key has been struck and not yet released.
+     */
+    bool down(uint16_t key) const { return (_down[key / 32] >> (key % 32)) & 1; }
+private:
+    // The octave of tm, which must not be 0, followed by the step_bits bits
+    // below its highest set bit.
+    static uint16_t log_step(uint32_t tm, uint8_t step_bits)
+    {
+        uint8_t octave = highest_bit(tm);
+        uint32_t fraction = octave >= step_bits ? tm >> (octave - step_bits) : tm << (step_bits - octave);
+        return (uint16_t(octave) << step_bits) | (fraction & ((uint32_t(1) << step_bits) - 1));
+    }
+};
+
+template <uint16_t KEYS> const uint32_t VelocityKeyScanner<KEYS>::WORDS;
+template <uint16_t KEYS> const uint8_t VelocityKeyScanner<KEYS>::VELOCITY_STEPS;
+template <uint16_t KEYS> const uint32_t VelocityKeyScanner<KEYS>::MIN_STRIKE_TM;
+template <uint16_t KEYS> const uint32_t VelocityKeyScanner<KEYS>::MAX_STRIKE_TM;
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,135 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef vertical_counter_h
+#define vertical_counter_h
+
+#include "ButtonBank.h"
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * Debounces every bit of a word at once using vertical counters: bit i of
+ * each of the BITS counter planes together form the counter for input i.
+ * A bit's debounced state changes once its samples have differed from it
+ * 2^BITS times in a row, which spans 2^BITS - 1 scan periods, so with the
+ * default of 2 bits and a 5ms scan the debounce period is 15ms. The cost of
+ * an update is a few bitwise operations per plane regardless of how many bits
+ * the word holds.
+ */
+template <typename Word, uint8_t BITS = 2>
+class VerticalCounter
+{
+    Word _state = 0;
+    Word _planes[BITS] = {};
+
+public:
+    /**
+     * Adds a sample of every input, and returns a mask of the bits whose
+     * debounced state changed.
+     */
+    Word update(Word sample)
+    {
+        Word delta = sample ^ _state;
+
+        // Count up where the sample differs, and reset elsewhere. The carry
+        // out of the last plane marks counters that have wrapped around.
+        Word carry = delta;
+        for (uint8_t i = 0; i < BITS; ++i) {
+            Word plane = _planes[i];
+            _planes[i] = (plane ^ carry) & delta;
+            carry &= plane;
+        }
+
+        _state ^= carry;
+        return carry;
+    }
+
+    /**
+     * Returns the debounced state of every input.
+     */
+    Word state() const { return _state; }
+};
+
+/**
+ * Returns the number of counter bits needed for a debounce period of at least
+ * debounce_ms when sampling every period_ms. The 2^bits samples that change a
+ * counter's state span 2^bits - 1 periods.
+ */
+constexpr uint8_t counter_bits_for(uint32_t debounce_ms, uint32_t period_ms, uint8_t bits = 1)
+{
+    return (period_ms << bits) - period_ms >= debounce_ms || bits >= 8 ? bits : counter_bits_for(debounce_ms, period_ms, bits + 1);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/**
+ * A DebouncedButton for each bit of a word, debounced together by a
+ * VerticalCounter. Only buttons whose debounced state changed, or that are
+ * waiting on a gesture timeout, have their gesture state updated.
+ */
+template <typename Word, uint8_t BITS = 2>
+class VerticalCounterBank
+{
+public:
+    static const uint8_t SIZE = ButtonBank<Word>::SIZE;
+
+private:
+    VerticalCounter<Word, BITS> _counter;
+    Word _invert;
+    ButtonBank<Word> _bank;
+
+public:
+    /**
+     * Creates a new instance with the specified polarity, which has a bit set
+     * for each input that reads 1 when its button is pressed.
+     */
+    VerticalCounterBank(Word pressed_state = Word(~Word(0)))
+        : _invert(~pressed_state)
+    { }
+
+    /**
+     * Adds a sample of every button, calling on_input(index, input) for each
+     * recognized Input.
+     */
+    template <typename F>
+    void update(Word sample, uint32_t tm, F&& on_input)
+    {
+        _counter.update(sample ^ _invert);
+        _bank.update(_counter.state(), tm, on_input);
+    }
+
+    /**
+     * Returns a mask of the buttons whose debounced state is pressed.
+     */
+    Word state() const { return _counter.state(); }
+
+    // Bulk queries, as for ButtonBank.
+    Word pressed_mask() const { return _bank.pressed_mask(); }
+    Word pending_mask() const { return _bank.pending_mask(); }
+    Word changed_since(uint32_t tm) const { return _bank.changed_since(tm); }
+
+    DebouncedButton& button(uint8_t index) { return _bank.button(index); }
+    DebouncedButton const& button(uint8_t index) const { return _bank.button(index); }
+};
+
+/*---------------------------------------------------------------------------*/
+
+#endif
@@ -0,0 +1,323 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Measures the host cost of DebouncedButton::update. Not run by ctest; build
+// the bench_debounced_button target and run it directly.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/BitStreamBank.h"
+#include "../src/DebouncedButton.h"
+#include "../src/SlicedScanner.h"
+#include "../src/SparseBank.h"
+#include "../src/SplitBank.h"
+#include "../src/VelocityKeyScanner.h"
+#include "../src/VerticalCounter.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+const int NUM_BUTTONS = 256;
+const uint32_t NUM_TICKS = 20000;
+
+// Readings for every button at every tick, with clicks, holds and contact
+// bounce at random times.
+std::vector<uint8_t> make_trace(std::mt19937& rng)
+{
+    std::vector<uint8_t> trace(size_t(NUM_BUTTONS) * NUM_TICKS);
+    std::uniform_int_distribution<uint32_t> gap_ms(50, 2000);
+    std::uniform_int_distribution<uint32_t> press_ms(30, 600);
+    std::uniform_int_distribution<uint32_t> bounce_ms(0, 8);
+
+    for (int b = 0; b < NUM_BUTTONS; ++b) {
+        uint32_t tm = gap_ms(rng);
+        while (tm < NUM_TICKS) {
+            uint32_t bounce_end = tm + bounce_ms(rng);
+            uint32_t release_tm = tm + press_ms(rng);
+            for (; tm < release_tm && tm < NUM_TICKS; ++tm)
+                trace[size_t(tm) * NUM_BUTTONS + b] = tm >= bounce_end || (tm & 1);
+            tm += gap_ms(rng);
+        }
+    }
+    return trace;
+}
+
+template <typename F>
+double time_ns_per_update(char const* name, uint32_t start_tm, F&& reading)
+{
+    std::vector<DebouncedButton> buttons(NUM_BUTTONS);
+    unsigned inputs = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        uint32_t tm = start_tm + tick;
+        for (int b = 0; b < NUM_BUTTONS; ++b)
+            inputs += buttons[b].update(reading(tick, b), tm) != DebouncedButton::NONE;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_update = ns / (double(NUM_TICKS) * NUM_BUTTONS);
+    std::printf("%-24s %8.2f ns/update  (%u inputs)\n", name, per_update, inputs);
+    return per_update;
+}
+
+template <typename F>
+double time_bank_ns_per_button(char const* name, F&& reading)
+{
+    const int NUM_BANKS = NUM_BUTTONS / 32;
+    std::vector<VerticalCounterBank<uint32_t>> banks(NUM_BANKS);
+    unsigned inputs = 0;
+
+    // Pack the readings into words ahead of time, as a port read would.
+    std::vector<uint32_t> samples(size_t(NUM_TICKS) * NUM_BANKS);
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick)
+        for (int b = 0; b < NUM_BUTTONS; ++b)
+            samples[size_t(tick) * NUM_BANKS + b / 32] |= uint32_t(reading(tick, b)) << (b % 32);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        for (int k = 0; k < NUM_BANKS; ++k) {
+            banks[k].update(samples[size_t(tick) * NUM_BANKS + k], tick,
+                            [&](uint8_t, DebouncedButton::Input) { ++inputs; });
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_button = ns / (double(NUM_TICKS) * NUM_BUTTONS);
+    std::printf("%-24s %8.2f ns/button  (%u inputs)\n", name, per_button, inputs);
+    return per_button;
+}
+
+template <typename F>
+double time_stream_bank_ns_per_button(char const* name, F&& reading)
+{
+    const int NUM_BANKS = NUM_BUTTONS / 32;
+    const uint32_t NUM_BLOCKS = NUM_TICKS / 32;
+    std::vector<BitStreamBank<uint32_t>> banks(NUM_BANKS);
+    unsigned inputs = 0;
+
+    // Blocks of 32 samples per bank, as a DMA transfer would capture them.
+    std::vector<uint32_t> samples(size_t(NUM_BLOCKS) * NUM_BANKS * 32);
+    for (uint32_t tick = 0; tick < NUM_BLOCKS * 32; ++tick)
+        for (int b = 0; b < NUM_BUTTONS; ++b)
+            samples[(size_t(tick / 32) * NUM_BANKS + b / 32) * 32 + tick % 32] |= uint32_t(reading(tick, b)) << (b % 32);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t block = 0; block < NUM_BLOCKS; ++block) {
+        for (int k = 0; k < NUM_BANKS; ++k) {
+            auto& words = *reinterpret_cast<uint32_t(*)[32]>(&samples[(size_t(block) * NUM_BANKS + k) * 32]);
+            banks[k].update(words, block * 32, 1, [&](uint8_t, DebouncedButton::Input) { ++inputs; });
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_button = ns / (double(NUM_BLOCKS) * 32 * NUM_BUTTONS);
+    std::printf("%-24s %8.2f ns/button  (%u inputs)\n", name, per_button, inputs);
+    return per_button;
+}
+
+template <typename F>
+double time_key_scan_ns(char const* name, F&& reading)
+{
+    using Scanner = VelocityKeyScanner<88>;
+    Scanner scanner;
+    unsigned notes = 0;
+
+    // The second contact closes a few ticks after the first.
+    std::vector<uint32_t> first(size_t(NUM_TICKS) * Scanner::WORDS), second(first.size());
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        for (int key = 0; key < 88; ++key) {
+            size_t w = size_t(tick) * Scanner::WORDS + key / 32;
+            first[w] |= uint32_t(reading(tick, key)) << (key % 32);
+            second[w] |= uint32_t(tick >= 4 && reading(tick - 4, key) && reading(tick, key)) << (key % 32);
+        }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        auto& f = *reinterpret_cast<uint32_t const(*)[Scanner::WORDS]>(&first[size_t(tick) * Scanner::WORDS]);
+        auto& s = *reinterpret_cast<uint32_t const(*)[Scanner::WORDS]>(&second[size_t(tick) * Scanner::WORDS]);
+        scanner.update(f, s, tick * 1000, [&](uint16_t, uint8_t) { ++notes; });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_scan = ns / NUM_TICKS;
+    std::printf("%-24s %8.2f ns/scan    (%u notes)\n", name, per_scan, notes);
+    return per_scan;
+}
+
+template <typename F>
+double time_sliced_ns_per_tick(char const* name, F&& reading)
+{
+    // The traced buttons are spread through a bank of 50,000.
+    const uint32_t SIZE = 50000;
+    const uint32_t STRIDE = SIZE / NUM_BUTTONS;
+    using Scanner = SlicedScanner<SIZE>;
+    std::unique_ptr<Scanner> scanner(new Scanner(10));
+    unsigned inputs = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        scanner->update(tick,
+                        [&](uint32_t i) { return i % STRIDE == 0 && i / STRIDE < NUM_BUTTONS && reading(tick, i / STRIDE); },
+                        [&](uint32_t, DebouncedButton::Input) { ++inputs; });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_tick = ns / NUM_TICKS;
+    std::printf("%-24s %8.0f ns/tick    (%u inputs)\n", name, per_tick, inputs);
+    return per_tick;
+}
+
+template <typename F>
+double time_sparse_ns_per_tick(char const* name, F&& reading)
+{
+    // The traced buttons are spread through a bank of 50,000, and only their
+    // readings are delivered.
+    const uint32_t SIZE = 50000;
+    const uint32_t STRIDE = SIZE / NUM_BUTTONS;
+    using Bank = SparseBank<SIZE>;
+    std::unique_ptr<Bank> bank(new Bank);
+    unsigned inputs = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < NUM_TICKS; ++tick) {
+        for (int b = 0; b < NUM_BUTTONS; ++b)
+            bank->set_reading(b * STRIDE, reading(tick, b));
+        bank->update(tick, [&](uint32_t, DebouncedButton::Input) { ++inputs; });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_tick = ns / NUM_TICKS;
+    std::printf("%-24s %8.0f ns/tick    (%u inputs)\n", name, per_tick, inputs);
+    return per_tick;
+}
+
+// 100,000 buttons with the traced ones spread through them, scanned from
+// packed readings every tick, first as an array of DebouncedButton objects
+// and then with the hot and cold columns of a SplitBank. Fewer ticks are run
+// since every tick reads every button.
+const uint32_t LARGE_SIZE = 100000;
+const uint32_t LARGE_WORDS = (LARGE_SIZE + 63) / 64;
+const uint32_t LARGE_TICKS = 2000;
+
+template <typename F>
+std::vector<uint64_t> make_large_readings(F&& reading)
+{
+    const uint32_t STRIDE = LARGE_SIZE / NUM_BUTTONS;
+    std::vector<uint64_t> readings(size_t(LARGE_TICKS) * LARGE_WORDS);
+    for (uint32_t tick = 0; tick < LARGE_TICKS; ++tick)
+        for (int b = 0; b < NUM_BUTTONS; ++b)
+            readings[size_t(tick) * LARGE_WORDS + b * STRIDE / 64] |= uint64_t(reading(tick, b)) << (b * STRIDE % 64);
+    return readings;
+}
+
+template <typename F>
+double time_objects_ns_per_tick(char const* name, F&& reading)
+{
+    auto readings = make_large_readings(reading);
+    std::vector<DebouncedButton> buttons(LARGE_SIZE);
+    unsigned inputs = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < LARGE_TICKS; ++tick) {
+        uint64_t const* words = &readings[size_t(tick) * LARGE_WORDS];
+        for (uint32_t b = 0; b < LARGE_SIZE; ++b)
+            inputs += buttons[b].update((words[b / 64] >> (b % 64)) & 1, tick) != DebouncedButton::NONE;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_tick = ns / LARGE_TICKS;
+    std::printf("%-24s %8.0f ns/tick    (%u inputs, %zu bytes/tick)\n", name, per_tick, inputs,
+                sizeof(DebouncedButton) * LARGE_SIZE);
+    return per_tick;
+}
+
+template <typename F>
+double time_split_ns_per_tick(char const* name, F&& reading)
+{
+    auto readings = make_large_readings(reading);
+    using Bank = SplitBank<LARGE_SIZE>;
+    std::unique_ptr<Bank> bank(new Bank);
+    unsigned inputs = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < LARGE_TICKS; ++tick) {
+        auto& words = *reinterpret_cast<uint64_t const(*)[LARGE_WORDS]>(&readings[size_t(tick) * LARGE_WORDS]);
+        bank->update(words, tick, [&](uint32_t, DebouncedButton::Input) { ++inputs; });
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_tick = ns / LARGE_TICKS;
+    std::printf("%-24s %8.0f ns/tick    (%u inputs, %zu hot bytes/tick)\n", name, per_tick, inputs,
+                size_t(LARGE_WORDS) * 3 * sizeof(uint64_t));
+    return per_tick;
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
+
+int main()
+{
+    std::mt19937 rng(123456);
+    auto trace = make_trace(rng);
+
+    auto idle = [](uint32_t, int) { return false; };
+    auto active = [&](uint32_t tick, int b) { return trace[size_t(tick) * NUM_BUTTONS + b] != 0; };
+
+    time_ns_per_update("idle", 0, idle);
+    time_ns_per_update("active", 0, active);
+    time_ns_per_update("active across rollover", UINT32_MAX - NUM_TICKS / 2, active);
+
+    time_bank_ns_per_button("vertical bank idle", idle);
+    time_bank_ns_per_button("vertical bank active", active);
+
+    time_stream_bank_ns_per_button("stream bank idle", idle);
+    time_stream_bank_ns_per_button("stream bank active", active);
+
+    time_key_scan_ns("88 key scan idle", idle);
+    time_key_scan_ns("88 key scan active", active);
+
+    time_sliced_ns_per_tick("sliced 50k idle", idle);
+    time_sliced_ns_per_tick("sliced 50k active", active);
+
+    time_sparse_ns_per_tick("sparse 50k idle", idle);
+    time_sparse_ns_per_tick("sparse 50k active", active);
+
+    time_objects_ns_per_tick("objects 100k idle", idle);
+    time_objects_ns_per_tick("objects 100k active", active);
+    time_split_ns_per_tick("split 100k idle", idle);
+    time_split_ns_per_tick("split 100k active", active);
+
+    return 0;
+}
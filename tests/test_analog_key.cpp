@@ -0,0 +1,132 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/AnalogKey.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestAnalogKey : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+const RapidTrigger SETTINGS = { 200, 30, 20 };
+
+TEST_F(TestAnalogKey, TestRapidTrigger)
+{
+    bool pressed = false;
+    uint16_t extremum = 0;
+
+    // Nothing presses the key above the actuation point
+    EXPECT_FALSE(rapid_trigger(SETTINGS, pressed, extremum, 199));
+
+    // Pressed beyond it, then released by moving up the release delta even
+    // though still beyond the actuation point
+    EXPECT_TRUE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 200));
+    EXPECT_TRUE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 600));
+    EXPECT_TRUE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 581));
+    EXPECT_FALSE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 580));
+
+    // Moving down the press delta from the highest point presses it again
+    EXPECT_FALSE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 500));
+    EXPECT_FALSE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 529));
+    EXPECT_TRUE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 530));
+
+    // Coming back above the actuation point always releases it
+    EXPECT_TRUE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 520));
+    EXPECT_FALSE(pressed = rapid_trigger(SETTINGS, pressed, extremum, 199));
+}
+
+TEST_F(TestAnalogKey, TestGestures)
+{
+    AnalogKey key(SETTINGS);
+    uint32_t tm = 0;
+    std::vector<DebouncedButton::Input> inputs;
+    auto travel_to = [&](uint16_t travel, uint32_t ms) {
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            auto input = key.update(travel, tm);
+            if (input != DebouncedButton::NONE)
+                inputs.push_back(input);
+        }
+    };
+
+    // Two taps without ever leaving the bottom of the key's travel are a
+    // double click
+    travel_to(0, 100);
+    travel_to(700, 50);
+    travel_to(650, 50);
+    travel_to(700, 50);
+    travel_to(650, 300);
+    EXPECT_EQ(std::vector<DebouncedButton::Input>({ DebouncedButton::DOUBLE_CLICK }), inputs);
+}
+
+TEST_F(TestAnalogKey, TestBankMatchesKeys)
+{
+    const uint16_t KEYS = 100;
+    AnalogKeyBank<KEYS> bank(SETTINGS);
+    std::vector<AnalogKey> keys(KEYS, AnalogKey(SETTINGS));
+
+    std::uniform_int_distribution<int> target(0, 1023);
+    std::uniform_int_distribution<int> step(0, 40);
+    uint16_t travel[KEYS] = {}, goal[KEYS] = {};
+
+    std::vector<std::vector<DebouncedButton::Input>> expected(KEYS), actual(KEYS);
+
+    for (uint32_t tm = 0; tm < 20000; ++tm) {
+        for (int k = 0; k < KEYS; ++k) {
+            if (travel[k] == goal[k])
+                goal[k] = target(_rng);
+            int delta = std::min(step(_rng), std::abs(goal[k] - travel[k]));
+            travel[k] += goal[k] > travel[k] ? delta : -delta;
+
+            auto input = keys[k].update(travel[k], tm);
+            if (input != DebouncedButton::NONE)
+                expected[k].push_back(input);
+        }
+
+        bank.update(travel, tm, [&](uint16_t k, DebouncedButton::Input input) {
+            actual[k].push_back(input);
+        });
+    }
+
+    for (int k = 0; k < KEYS; ++k) {
+        SCOPED_TRACE("key " + std::to_string(k));
+        EXPECT_LT(20u, expected[k].size());
+        EXPECT_EQ(expected[k], actual[k]);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,172 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/BitStreamBank.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestBitStreamBank : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+
+    template <typename Word>
+    void check_transpose()
+    {
+        const int N = sizeof(Word) * 8;
+        std::uniform_int_distribution<uint64_t> bits;
+        for (int trial = 0; trial < 100; ++trial) {
+            Word m[N], original[N];
+            for (int i = 0; i < N; ++i)
+                m[i] = original[i] = Word(bits(_rng));
+
+            transpose(m);
+            for (int i = 0; i < N; ++i)
+                for (int j = 0; j < N; ++j)
+                    ASSERT_EQ((original[i] >> j) & 1, (m[j] >> i) & 1);
+        }
+    }
+};
+
+TEST_F(TestBitStreamBank, TestTranspose)
+{
+    check_transpose<uint8_t>();
+    check_transpose<uint16_t>();
+    check_transpose<uint32_t>();
+    check_transpose<uint64_t>();
+}
+
+TEST_F(TestBitStreamBank, TestBankMatchesButtons)
+{
+    for (uint32_t interval_ms : { 1, 3 }) {
+        SCOPED_TRACE("interval " + std::to_string(interval_ms));
+
+        // Active-low buttons in the low half of the word
+        BitStreamBank<uint32_t> bank(0xffff0000);
+        DebouncedButton buttons[32];
+        for (int i = 0; i < 32; ++i)
+            buttons[i] = DebouncedButton(i >= 16);
+
+        std::uniform_int_distribution<int> hold_ms(10, 400);
+        std::uniform_int_distribution<int> bounce(0, 3);
+        uint32_t change_tm[32] = {};
+        uint32_t next_change_tm[32] = {};
+        bool pressed[32] = {};
+
+        std::vector<std::vector<DebouncedButton::Input>> expected(32), actual(32);
+
+        uint32_t tm = 0;
+        while (tm < 60000 * interval_ms) {
+            uint32_t block[32];
+            uint32_t block_tm = tm;
+            for (int k = 0; k < 32; ++k, tm += interval_ms) {
+                block[k] = 0;
+                for (int i = 0; i < 32; ++i) {
+                    if (tm >= next_change_tm[i]) {
+                        pressed[i] = !pressed[i];
+                        change_tm[i] = tm;
+                        next_change_tm[i] = tm + hold_ms(_rng);
+                    }
+                    // Readings bounce for a few samples after each change
+                    bool reading = pressed[i];
+                    if (tm - change_tm[i] < 5 && bounce(_rng) == 0)
+                        reading = !reading;
+                    if (i < 16)
+                        reading = !reading;
+                    block[k] |= uint32_t(reading) << i;
+
+                    auto input = buttons[i].update(reading, tm);
+                    if (input != DebouncedButton::NONE)
+                        expected[i].push_back(input);
+                }
+            }
+
+            bank.update(block, block_tm, interval_ms, [&](uint8_t i, DebouncedButton::Input input) {
+                actual[i].push_back(input);
+            });
+
+            // The bulk queries agree with the buttons after every block
+            uint32_t pressed_mask = 0, pending_mask = 0, changed_mask = 0;
+            for (int i = 0; i < 32; ++i) {
+                pressed_mask |= uint32_t(buttons[i].state()) << i;
+                pending_mask |= uint32_t(buttons[i].input_pending()) << i;
+                if (DebouncedButton::reached(block_tm, buttons[i].last_change_tm()))
+                    changed_mask |= uint32_t(1) << i;
+            }
+            ASSERT_EQ(pressed_mask, bank.pressed_mask());
+            ASSERT_EQ(pending_mask, bank.pending_mask());
+            if (block_tm) {
+                ASSERT_EQ(changed_mask, bank.changed_since(block_tm));
+            }
+        }
+
+        for (int i = 0; i < 32; ++i) {
+            SCOPED_TRACE("button " + std::to_string(i));
+            EXPECT_LT(20u, expected[i].size());
+            EXPECT_EQ(expected[i], actual[i]);
+        }
+    }
+}
+
+TEST_F(TestBitStreamBank, TestForgetsOldChanges)
+{
+    using Bank = BitStreamBank<uint8_t>;
+    Bank bank;
+    auto none = [](uint8_t, DebouncedButton::Input) { };
+    uint8_t block[Bank::SIZE];
+    auto fill = [&](uint8_t readings) {
+        for (uint8_t k = 0; k < Bank::SIZE; ++k)
+            block[k] = readings;
+    };
+
+    // Button 1 is pressed in the first block, which is transposed in place
+    fill(0x02);
+    bank.update(block, 0, 10, none);
+    EXPECT_EQ(0x02, bank.pressed_mask());
+    EXPECT_EQ(0x02, bank.changed_since(DebouncedButton::DEBOUNCE_MS));
+    EXPECT_EQ(0, bank.changed_since(DebouncedButton::DEBOUNCE_MS + 1));
+
+    // Blocks far apart take the time past 2^31 ms, where button 1's change
+    // would look recent again if it were still remembered
+    uint32_t tm = 100;
+    for (; tm < (uint32_t(3) << 30); tm += uint32_t(1) << 28) {
+        fill(0x02);
+        bank.update(block, tm, 10, none);
+    }
+    fill(0x06);
+    bank.update(block, tm, 10, none);
+    EXPECT_EQ(0x06, bank.pressed_mask());
+    EXPECT_EQ(0x04, bank.changed_since(tm - Bank::CHANGE_HORIZON_MS / 2));
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
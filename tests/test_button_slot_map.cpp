@@ -0,0 +1,116 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/ButtonSlotMap.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+using SlotMap = ButtonSlotMap<8>;
+using Handle = ButtonHandle;
+
+TEST(TestButtonSlotMap, TestAddRemove)
+{
+    SlotMap map;
+    EXPECT_FALSE(map.contains(SlotMap::INVALID));
+    EXPECT_FALSE(map.contains(Handle{ 3, 1 }));
+
+    std::vector<Handle> handles;
+    for (int i = 0; i < 8; ++i)
+        handles.push_back(map.add());
+    EXPECT_EQ(8, map.size());
+    EXPECT_EQ(SlotMap::INVALID, map.add());
+
+    // Removing from the middle keeps the others reachable and packed
+    EXPECT_TRUE(map.remove(handles[2]));
+    EXPECT_FALSE(map.remove(handles[2]));
+    EXPECT_EQ(7, map.size());
+    EXPECT_EQ(nullptr, map.get(handles[2]));
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(i != 2, map.contains(handles[i]));
+    for (uint16_t i = 0; i < map.size(); ++i)
+        EXPECT_TRUE(map.contains(map.handle_at(i)));
+
+    // The slot is reused with a new generation, so the old handle stays stale
+    Handle reused = map.add(false);
+    EXPECT_EQ(handles[2].slot, reused.slot);
+    EXPECT_NE(handles[2].generation, reused.generation);
+    EXPECT_FALSE(map.contains(handles[2]));
+    EXPECT_TRUE(map.contains(reused));
+}
+
+TEST(TestButtonSlotMap, TestUpdate)
+{
+    // Buttons plugged and unplugged at random keep their own state
+    ButtonSlotMap<32> map;
+    std::map<uint32_t, DebouncedButton> reference;
+    std::map<uint32_t, std::vector<DebouncedButton::Input>> expected, actual;
+    auto key = [](Handle h) { return uint32_t(h.slot) << 16 | h.generation; };
+
+    std::mt19937 rng(123456);
+    std::uniform_int_distribution<int> action(0, 199);
+    std::uniform_int_distribution<int> hold(0, 1);
+    std::vector<Handle> live;
+    std::map<uint32_t, bool> readings;
+
+    for (uint32_t tm = 0; tm < 20000; ++tm) {
+        int a = action(rng);
+        if (a == 0 && !live.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+            size_t i = pick(rng);
+            EXPECT_TRUE(map.remove(live[i]));
+            reference.erase(key(live[i]));
+            live.erase(live.begin() + i);
+        } else if (a == 1) {
+            Handle h = map.add();
+            if (h != map.INVALID) {
+                live.push_back(h);
+                reference.emplace(key(h), DebouncedButton());
+                readings[key(h)] = false;
+            }
+        }
+
+        if (tm % 100 == 0)
+            for (auto h : live)
+                readings[key(h)] = hold(rng);
+
+        for (auto h : live) {
+            auto input = reference[key(h)].update(readings[key(h)], tm);
+            if (input != DebouncedButton::NONE)
+                expected[key(h)].push_back(input);
+        }
+        map.update(tm, [&](Handle h) { return readings[key(h)]; },
+                   [&](Handle h, DebouncedButton::Input input) { actual[key(h)].push_back(input); });
+        EXPECT_EQ(live.size(), map.size());
+    }
+
+    EXPECT_LT(10u, expected.size());
+    EXPECT_EQ(expected, actual);
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 #include <random>
 #include <tuple>
+#include <vector>
 
 #include "../src/DebouncedButton.h"
 
@@ -99,6 +100,14 @@ TEST_F(TestDebouncedButton, TestInitialState)
 
     EXPECT_EQ(0, button.prev_duration(0));
     EXPECT_EQ(0, button.prev_duration(12345));
+
+    // Active-low buttons start released too, and report pressed as true
+    DebouncedButton active_low(false);
+    EXPECT_FALSE(active_low.state());
+    EXPECT_FALSE(active_low.debouncing());
+    for (uint32_t tm = 0; tm <= DebouncedButton::DEBOUNCE_MS; ++tm)
+        active_low.update(false, tm);
+    EXPECT_TRUE(active_low.state());
 }
 
 TEST_F(TestDebouncedButton, TestFirstReading)
@@ -662,6 +671,658 @@ TEST_F(TestDebouncedButton, TestTriplePressAndRelease)
     }
 }
 
+TEST_F(TestDebouncedButton, TestTimingProfiles)
+{
+    DebouncedButton::Profile slow = DebouncedButton::profile(0);
+    slow.double_click_timeout_ms = 3 * DebouncedButton::DOUBLE_CLICK_TIMEOUT_MS;
+    DebouncedButton::set_profile(1, slow);
+
+    // A click followed by a second press that would be too late for the
+    // default timeout is a double click with the slower profile.
+    {
+        DebouncedButton button(true, 1);
+        EXPECT_EQ(1, button.profile_index());
+
+        uint32_t first_press_tm = 0;
+        uint32_t first_release_tm = first_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+
+        uint32_t second_press_tm = first_release_tm + button.DEBOUNCE_MS + button.DOUBLE_CLICK_TIMEOUT_MS + 10;
+        uint32_t second_release_tm = second_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+
+        uint32_t double_clicked_tm = second_release_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS;
+
+        ScriptPoint slow_double_click_script[] = {
+            { first_press_tm, true },
+            { first_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::NONE, true },
+            // Past the default double click timeout, still pending
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::NONE, true },
+            { double_clicked_tm, false, DebouncedButton::DOUBLE_CLICK }
+        };
+
+        RUN_SCRIPT(slow_double_click, button);
+    }
+
+    // Out of range indexes are ignored
+    {
+        DebouncedButton button(true, DebouncedButton::MAX_PROFILES);
+        EXPECT_EQ(0, button.profile_index());
+        button.set_profile_index(1);
+        button.set_profile_index(DebouncedButton::MAX_PROFILES);
+        EXPECT_EQ(1, button.profile_index());
+    }
+
+    // Profiles can be brace-initialized from their leading fields, and the
+    // rest keep their defaults
+    {
+        DebouncedButton::Profile braced = { 10, 150, 300 };
+        EXPECT_EQ(10u, braced.debounce_ms);
+        EXPECT_EQ(150u, braced.clicked_cutoff_ms);
+        EXPECT_EQ(300u, braced.double_click_timeout_ms);
+        EXPECT_EQ(DebouncedButton::DEBOUNCE_MS, braced.min_debounce_ms);
+        EXPECT_EQ(DebouncedButton::ALL_GESTURES, braced.gestures);
+        EXPECT_EQ(0u, braced.hold_stage_ms[0]);
+        EXPECT_EQ(DebouncedButton::DEBOUNCE_MS, braced.release_debounce_ms);
+    }
+
+    DebouncedButton::reset_profiles();
+    EXPECT_EQ(DebouncedButton::DOUBLE_CLICK_TIMEOUT_MS, DebouncedButton::profile(1).double_click_timeout_ms);
+}
+
+TEST_F(TestDebouncedButton, TestAdaptiveDebounce)
+{
+    DebouncedButton::Profile adaptive = DebouncedButton::profile(0);
+    adaptive.min_debounce_ms = 5;
+    DebouncedButton::set_profile(1, adaptive);
+
+    DebouncedButton button(true, 1);
+    EXPECT_EQ(button.DEBOUNCE_MS, button.debounce_window());
+
+    uint32_t tm = 0;
+    auto hold = [&](bool reading, uint32_t ms) {
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm)
+            button.update(reading, tm);
+    };
+
+    // Clean presses and releases shrink the window to the minimum
+    for (int i = 0; i < 30; ++i) {
+        hold(true, 60);
+        hold(false, 300);
+    }
+    EXPECT_EQ(adaptive.min_debounce_ms, button.debounce_window());
+
+    // And the shorter window reduces latency
+    hold(true, adaptive.min_debounce_ms);
+    EXPECT_FALSE(button.state());
+    hold(true, 1);
+    EXPECT_TRUE(button.state());
+    hold(true, 60);
+
+    // A release that bounces for 9ms grows the window past the bounce
+    hold(false, 2);
+    hold(true, 2);
+    hold(false, 4);
+    hold(true, 1);
+    hold(false, 20);
+    EXPECT_FALSE(button.state());
+    EXPECT_EQ(9 + 9 / 2 + 1, button.debounce_window());
+
+    // Windows longer than a byte's worth of milliseconds are not truncated
+    adaptive.debounce_ms = 400;
+    adaptive.min_debounce_ms = 10;
+    DebouncedButton::set_profile(1, adaptive);
+    DebouncedButton slow(true, 1);
+    EXPECT_EQ(400, slow.debounce_window());
+    tm = 0;
+    for (; tm < 400; ++tm)
+        slow.update(true, tm);
+    EXPECT_FALSE(slow.state());
+    slow.update(true, tm);
+    EXPECT_TRUE(slow.state());
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestReleaseDebounce)
+{
+    DebouncedButton::Profile asymmetric = DebouncedButton::profile(0);
+    asymmetric.release_debounce_ms = 2;
+    DebouncedButton::set_profile(1, asymmetric);
+
+    DebouncedButton button(true, 1);
+
+    uint32_t tm = 0;
+    std::vector<DebouncedButton::Input> inputs;
+    auto hold = [&](bool reading, uint32_t ms) {
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            auto input = button.update(reading, tm);
+            if (input != DebouncedButton::NONE)
+                inputs.push_back(input);
+        }
+    };
+
+    // Presses still take the full debounce period
+    hold(false, 100);
+    hold(true, button.DEBOUNCE_MS);
+    EXPECT_FALSE(button.state());
+    hold(true, 1);
+    EXPECT_TRUE(button.state());
+    hold(true, 50);
+
+    // Releases take only the release period, restarted by any bounce
+    hold(false, 1);
+    hold(true, 1);
+    hold(false, asymmetric.release_debounce_ms);
+    EXPECT_TRUE(button.state());
+    hold(false, 1);
+    EXPECT_FALSE(button.state());
+
+    uint32_t deadline_tm;
+    EXPECT_TRUE(button.next_deadline(deadline_tm));
+    EXPECT_EQ(tm - 1 + button.DOUBLE_CLICK_TIMEOUT_MS + 1, deadline_tm);
+
+    // A release period longer than the press period is capped by it
+    asymmetric.release_debounce_ms = 100;
+    DebouncedButton::set_profile(1, asymmetric);
+    hold(false, 300);
+    hold(true, button.DEBOUNCE_MS + 50);
+    hold(false, button.DEBOUNCE_MS);
+    EXPECT_TRUE(button.state());
+    hold(false, 1);
+    EXPECT_FALSE(button.state());
+    hold(false, 300);
+
+    EXPECT_EQ(std::vector<DebouncedButton::Input>({ DebouncedButton::CLICK, DebouncedButton::CLICK }), inputs);
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestAdaptiveDoubleClickTimeout)
+{
+    DebouncedButton::Profile adaptive = DebouncedButton::profile(0);
+    adaptive.min_double_click_timeout_ms = 50;
+    adaptive.double_click_timeout_ms = 300;
+    DebouncedButton::set_profile(1, adaptive);
+
+    DebouncedButton button(true, 1);
+    EXPECT_EQ(adaptive.double_click_timeout_ms, button.double_click_timeout());
+
+    uint32_t tm = 0;
+    auto hold = [&](bool reading, uint32_t ms) {
+        DebouncedButton::Input input = DebouncedButton::NONE;
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            auto i = button.update(reading, tm);
+            if (i != DebouncedButton::NONE)
+                input = i;
+        }
+        return input;
+    };
+
+    // A user who only single clicks gets clicks delivered sooner
+    for (int i = 0; i < 40; ++i) {
+        hold(true, 60);
+        EXPECT_EQ(DebouncedButton::CLICK, hold(false, 400));
+    }
+    EXPECT_EQ(adaptive.min_double_click_timeout_ms, button.double_click_timeout());
+
+    // A second press that arrives just after the shortened timeout delivers
+    // a click, but widens the timeout to cover the observed gap
+    hold(true, 60);
+    EXPECT_EQ(DebouncedButton::CLICK, hold(false, 120));
+    hold(true, 60);
+    EXPECT_EQ(DebouncedButton::CLICK, hold(false, 400));
+    EXPECT_LE(120u, button.double_click_timeout());
+
+    // So the same cadence is now recognized as a double click
+    hold(true, 60);
+    EXPECT_EQ(DebouncedButton::NONE, hold(false, 120));
+    hold(true, 60);
+    EXPECT_EQ(DebouncedButton::DOUBLE_CLICK, hold(false, 400));
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestSpeculativeClick)
+{
+    DebouncedButton::Profile speculative = DebouncedButton::profile(0);
+    speculative.flags |= DebouncedButton::SPECULATIVE_CLICK;
+    DebouncedButton::set_profile(1, speculative);
+
+    // A single click is delivered on release and confirmed after the timeout
+    {
+        DebouncedButton button(true, 1);
+
+        uint32_t press_tm = 0;
+        uint32_t release_tm = press_tm + button.CLICKED_CUTOFF_MS - 10;
+        uint32_t confirmed_tm = release_tm + button.DEBOUNCE_MS + button.DOUBLE_CLICK_TIMEOUT_MS + 1;
+
+        ScriptPoint speculative_click_script[] = {
+            { press_tm, true },
+            { press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { release_tm, false, DebouncedButton::NONE, true },
+            { release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { confirmed_tm, false, DebouncedButton::CLICK_CONFIRMED },
+        };
+
+        RUN_SCRIPT(speculative_click, button);
+    }
+
+    // A double click upgrades the provisional click on the second release,
+    // and a third click is delivered provisionally
+    {
+        DebouncedButton button(true, 1);
+
+        uint32_t first_press_tm = 0;
+        uint32_t first_release_tm = first_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+        uint32_t second_press_tm = first_release_tm + button.DOUBLE_CLICK_TIMEOUT_MS - button.DEBOUNCE_MS - 10;
+        uint32_t second_release_tm = second_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+        uint32_t third_press_tm = second_release_tm + button.DEBOUNCE_MS + 10;
+        uint32_t third_release_tm = third_press_tm + button.DEBOUNCE_MS + 10;
+        uint32_t confirmed_tm = third_release_tm + button.DEBOUNCE_MS + button.DOUBLE_CLICK_TIMEOUT_MS + 1;
+
+        ScriptPoint speculative_triple_click_script[] = {
+            { first_press_tm, true },
+            { first_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK_UPGRADED_TO_DOUBLE },
+            { third_press_tm, true },
+            { third_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { third_release_tm, false, DebouncedButton::NONE, true },
+            { third_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { confirmed_tm, false, DebouncedButton::CLICK_CONFIRMED },
+        };
+
+        RUN_SCRIPT(speculative_triple_click, button);
+    }
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestDisabledGestures)
+{
+    // Without double clicks or click and long press, clicks are delivered
+    // on release
+    {
+        DebouncedButton::Profile simple = DebouncedButton::profile(0);
+        simple.gestures = 0;
+        DebouncedButton::set_profile(1, simple);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t press_tm = 0;
+        uint32_t release_tm = press_tm + button.CLICKED_CUTOFF_MS - 10;
+
+        ScriptPoint immediate_click_script[] = {
+            { press_tm, true },
+            { press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { release_tm, false, DebouncedButton::NONE, true },
+            { release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK },
+        };
+
+        RUN_SCRIPT(immediate_click, button);
+    }
+
+    // Without double click and long press, double clicks are delivered on
+    // the second release, and with click and long press disabled a click
+    // followed by a hold is a click and then a long press
+    {
+        DebouncedButton::Profile no_holds = DebouncedButton::profile(0);
+        no_holds.gestures = DebouncedButton::GESTURE_DOUBLE_CLICK;
+        DebouncedButton::set_profile(1, no_holds);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t first_press_tm = 0;
+        uint32_t first_release_tm = first_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+        uint32_t second_press_tm = first_release_tm + button.DOUBLE_CLICK_TIMEOUT_MS - button.DEBOUNCE_MS - 10;
+        uint32_t second_release_tm = second_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS - 10;
+        uint32_t third_press_tm = second_release_tm + button.DEBOUNCE_MS + 10;
+        uint32_t fourth_press_tm = third_press_tm + button.DEBOUNCE_MS + 10;
+        uint32_t hold_tm = fourth_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS;
+
+        ScriptPoint immediate_double_click_script[] = {
+            { first_press_tm, true },
+            { first_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::NONE, true },
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::DOUBLE_CLICK },
+            // A click followed by a hold
+            { third_press_tm, true },
+            { third_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { third_press_tm + button.DEBOUNCE_MS + 1, false, DebouncedButton::NONE, true },
+            { third_press_tm + 2 * button.DEBOUNCE_MS + 1, false, DebouncedButton::NONE, true },
+            { fourth_press_tm, true, DebouncedButton::NONE, true },
+            { fourth_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { hold_tm, true, DebouncedButton::CLICK, true },
+            { hold_tm + 1, true, DebouncedButton::LONG_PRESS },
+        };
+
+        RUN_SCRIPT(immediate_double_click, button);
+    }
+
+    // Without double clicks, a second click delivers the first, and the
+    // second is delivered when the timeout expires
+    {
+        DebouncedButton::Profile no_double = DebouncedButton::profile(0);
+        no_double.gestures = DebouncedButton::GESTURE_CLICK_AND_LONG_PRESS;
+        DebouncedButton::set_profile(1, no_double);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t first_release_tm = 100;
+        uint32_t second_press_tm = 150;
+        uint32_t second_release_tm = 220;
+        uint32_t timeout_tm = second_release_tm + button.DEBOUNCE_MS + button.DOUBLE_CLICK_TIMEOUT_MS + 1;
+
+        ScriptPoint separate_clicks_script[] = {
+            { 0, true },
+            { button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::NONE, true },
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { second_release_tm + button.DEBOUNCE_MS + 1, false, DebouncedButton::NONE, true },
+            { timeout_tm, false, DebouncedButton::CLICK },
+        };
+
+        RUN_SCRIPT(separate_clicks, button);
+    }
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestSpeculativeDisabledGestures)
+{
+    DebouncedButton::Profile speculative = DebouncedButton::profile(0);
+    speculative.flags = DebouncedButton::SPECULATIVE_CLICK;
+
+    // With nothing able to extend a click, the provisional click is
+    // confirmed on the next update, even one that completes a press
+    {
+        speculative.gestures = 0;
+        DebouncedButton::set_profile(1, speculative);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t release_tm = 100;
+        uint32_t press_tm = 200;
+
+        ScriptPoint confirmed_click_script[] = {
+            { 0, true },
+            { button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { release_tm, false, DebouncedButton::NONE, true },
+            { release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { release_tm + button.DEBOUNCE_MS + 1, false, DebouncedButton::CLICK_CONFIRMED },
+            { press_tm, true },
+            { press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { press_tm + 50, false, DebouncedButton::NONE, true },
+            { press_tm + 50 + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { press_tm + 50 + button.DEBOUNCE_MS + 1, true, DebouncedButton::NONE, true },
+            { press_tm + 50 + 2 * button.DEBOUNCE_MS + 1, true, DebouncedButton::CLICK_CONFIRMED, true },
+        };
+
+        RUN_SCRIPT(confirmed_click, button);
+    }
+
+    // Without double clicks, a second click confirms the first, its own
+    // provisional click follows on the next update, and a click followed
+    // by a hold supersedes the provisional click
+    {
+        speculative.gestures = DebouncedButton::GESTURE_CLICK_AND_LONG_PRESS;
+        DebouncedButton::set_profile(1, speculative);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t first_release_tm = 100;
+        uint32_t second_press_tm = 150;
+        uint32_t second_release_tm = 220;
+        uint32_t confirmed_tm = second_release_tm + button.DEBOUNCE_MS + button.DOUBLE_CLICK_TIMEOUT_MS + 1;
+        uint32_t third_press_tm = 500;
+        uint32_t fourth_press_tm = 600;
+        uint32_t hold_tm = fourth_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS;
+
+        ScriptPoint speculative_separate_clicks_script[] = {
+            { 0, true },
+            { button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK_CONFIRMED, true },
+            { second_release_tm + button.DEBOUNCE_MS + 1, false, DebouncedButton::CLICK, true },
+            { confirmed_tm - 1, false, DebouncedButton::NONE, true },
+            { confirmed_tm, false, DebouncedButton::CLICK_CONFIRMED },
+            // A click followed by a hold
+            { third_press_tm, true },
+            { third_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { third_press_tm + 60, false, DebouncedButton::NONE, true },
+            { third_press_tm + 60 + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { fourth_press_tm, true, DebouncedButton::NONE, true },
+            { fourth_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { hold_tm, true, DebouncedButton::CLICK_AND_LONG_PRESS },
+        };
+
+        RUN_SCRIPT(speculative_separate_clicks, button);
+    }
+
+    // Without the long press gestures, a double click upgrades the
+    // provisional click on the second release, and a click followed by a
+    // hold is confirmed before the long press
+    {
+        speculative.gestures = DebouncedButton::GESTURE_DOUBLE_CLICK;
+        DebouncedButton::set_profile(1, speculative);
+
+        DebouncedButton button(true, 1);
+
+        uint32_t first_release_tm = 100;
+        uint32_t second_press_tm = 150;
+        uint32_t second_release_tm = 220;
+        uint32_t third_press_tm = 300;
+        uint32_t fourth_press_tm = 400;
+        uint32_t hold_tm = fourth_press_tm + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS;
+
+        ScriptPoint speculative_double_click_script[] = {
+            { 0, true },
+            { button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { first_release_tm, false, DebouncedButton::NONE, true },
+            { first_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { second_press_tm, true, DebouncedButton::NONE, true },
+            { second_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { second_release_tm, false, DebouncedButton::NONE, true },
+            { second_release_tm + button.DEBOUNCE_MS, false, DebouncedButton::CLICK_UPGRADED_TO_DOUBLE },
+            // A click followed by a hold
+            { third_press_tm, true },
+            { third_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { third_press_tm + 60, false, DebouncedButton::NONE, true },
+            { third_press_tm + 60 + button.DEBOUNCE_MS, false, DebouncedButton::CLICK, true },
+            { fourth_press_tm, true, DebouncedButton::NONE, true },
+            { fourth_press_tm + button.DEBOUNCE_MS, true, DebouncedButton::NONE, true },
+            { hold_tm, true, DebouncedButton::CLICK_CONFIRMED, true },
+            { hold_tm + 1, true, DebouncedButton::LONG_PRESS },
+        };
+
+        RUN_SCRIPT(speculative_double_click, button);
+    }
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestHoldStages)
+{
+    DebouncedButton::Profile staged = DebouncedButton::profile(0);
+    staged.hold_stage_ms[0] = 3000;
+    staged.hold_stage_ms[1] = 10000;
+    DebouncedButton::set_profile(1, staged);
+
+    DebouncedButton button(true, 1);
+
+    uint32_t deadline_tm = 0;
+    EXPECT_FALSE(button.next_deadline(deadline_tm));
+
+    uint32_t press_tm = 100;
+    uint32_t pressed_tm = press_tm + button.DEBOUNCE_MS;
+    uint32_t release_tm = pressed_tm + 20000;
+
+    ScriptPoint hold_stages_script[] = {
+        { press_tm, true },
+        { pressed_tm, true, DebouncedButton::NONE, true },
+        { pressed_tm + button.CLICKED_CUTOFF_MS, true, DebouncedButton::LONG_PRESS },
+        { pressed_tm + 3000 - 1, true },
+        { pressed_tm + 3000, true, DebouncedButton::HOLD_STAGE_1 },
+        { pressed_tm + 3001, true },
+        { pressed_tm + 10000, true, DebouncedButton::HOLD_STAGE_2 },
+        { pressed_tm + 15000, true },
+        { release_tm, false },
+        { release_tm + button.DEBOUNCE_MS, false, DebouncedButton::RELEASE },
+    };
+
+    // Check the deadlines along the way
+    uint32_t expected_deadlines[] = {
+        press_tm + button.DEBOUNCE_MS,
+        pressed_tm + button.CLICKED_CUTOFF_MS,
+        pressed_tm + 3000,
+        pressed_tm + 3000,
+        pressed_tm + 10000,
+        pressed_tm + 10000,
+        0,
+        0,
+        release_tm + button.DEBOUNCE_MS,
+        0,
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(hold_stages_script); ++i) {
+        SCOPED_TRACE("i:" + std::to_string(i));
+        TestingScript("hold_stages", &hold_stages_script[i], 1).execute(button);
+        bool has_deadline = button.next_deadline(deadline_tm);
+        EXPECT_EQ(expected_deadlines[i] != 0, has_deadline);
+        if (has_deadline) {
+            EXPECT_EQ(expected_deadlines[i], deadline_tm);
+        }
+    }
+
+    DebouncedButton::reset_profiles();
+}
+
+TEST_F(TestDebouncedButton, TestEvents)
+{
+    DebouncedButton button;
+
+    uint32_t tm = 0;
+    std::vector<DebouncedButton::Event> events;
+    auto hold = [&](bool reading, uint32_t ms) {
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            auto event = button.update_event(reading, tm);
+            if (event.input != DebouncedButton::NONE)
+                events.push_back(event);
+        }
+    };
+
+    // A double click followed by a click
+    hold(true, 50);
+    hold(false, 50);
+    hold(true, 50);
+    hold(false, 50);
+    hold(true, 50);
+    hold(false, 500);
+    // A click and long press
+    hold(true, 50);
+    hold(false, 50);
+    hold(true, 500);
+    hold(false, 500);
+
+    ASSERT_EQ(4u, events.size());
+
+    EXPECT_EQ(DebouncedButton::DOUBLE_CLICK, events[0].input);
+    EXPECT_EQ(2, events[0].presses);
+    EXPECT_EQ(button.DEBOUNCE_MS, events[0].start_tm);
+    EXPECT_EQ(150 + button.DEBOUNCE_MS, events[0].end_tm);
+
+    EXPECT_EQ(DebouncedButton::CLICK, events[1].input);
+    EXPECT_EQ(1, events[1].presses);
+    EXPECT_EQ(200 + button.DEBOUNCE_MS, events[1].start_tm);
+    EXPECT_EQ(250 + button.DEBOUNCE_MS, events[1].end_tm);
+
+    EXPECT_EQ(DebouncedButton::CLICK_AND_LONG_PRESS, events[2].input);
+    EXPECT_EQ(2, events[2].presses);
+    EXPECT_EQ(750 + button.DEBOUNCE_MS, events[2].start_tm);
+    EXPECT_EQ(850 + button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS, events[2].end_tm);
+
+    EXPECT_EQ(DebouncedButton::RELEASE, events[3].input);
+    EXPECT_EQ(1, events[3].presses);
+    EXPECT_EQ(850 + button.DEBOUNCE_MS, events[3].start_tm);
+    EXPECT_EQ(1350 + button.DEBOUNCE_MS, events[3].end_tm);
+}
+
+TEST_F(TestDebouncedButton, TestRollover)
+{
+    EXPECT_EQ(10u, DebouncedButton::elapsed(UINT32_MAX - 4, 5));
+    EXPECT_EQ(0u, DebouncedButton::elapsed(5, UINT32_MAX - 4));
+    EXPECT_TRUE(DebouncedButton::reached(UINT32_MAX - 4, 5));
+    EXPECT_FALSE(DebouncedButton::reached(5, UINT32_MAX - 4));
+
+    // The same random presses produce the same inputs and durations whether
+    // or not millis() rolls over while they happen
+    std::uniform_int_distribution<uint32_t> hold_ms(1, 2 * DebouncedButton::CLICKED_CUTOFF_MS);
+    std::vector<std::pair<bool, uint32_t>> holds;
+    for (int i = 0; i < 200; ++i)
+        holds.emplace_back(i % 2 == 0, hold_ms(_rng));
+
+    uint32_t total_ms = 0;
+    for (auto const& h : holds)
+        total_ms += h.second;
+
+    auto run = [&](uint32_t start_tm) {
+        DebouncedButton button;
+        std::vector<std::tuple<DebouncedButton::Input, uint32_t, uint32_t>> inputs;
+        uint32_t tm = start_tm;
+        for (auto const& h : holds) {
+            for (uint32_t i = 0; i < h.second; ++i, ++tm) {
+                auto input = button.update(h.first, tm);
+                if (input != DebouncedButton::NONE)
+                    inputs.emplace_back(input, button.duration(tm), button.prev_duration());
+            }
+        }
+        // Durations are taken modulo 2^32
+        EXPECT_EQ(total_ms, button.duration(button.last_change_tm() + total_ms));
+        return inputs;
+    };
+
+    auto expected = run(1000);
+    EXPECT_LT(20u, expected.size());
+    EXPECT_EQ(expected, run(UINT32_MAX - total_ms / 2));
+
+    // Buttons left idle for more than 2^31 ms report the whole time
+    DebouncedButton idle;
+    EXPECT_EQ(3000000000u, idle.duration(3000000000u));
+    for (uint32_t i = 0; i < 200; ++i)
+        idle.update(i < 50, UINT32_MAX - 100 + i);
+    uint32_t released_tm = idle.last_change_tm();
+    EXPECT_FALSE(idle.state());
+    EXPECT_EQ(3000000000u, idle.duration(released_tm + 3000000000u));
+    idle.reset_duration();
+    EXPECT_EQ(3000000000u, idle.duration(3000000000u));
+
+    // And still debounce and recognize their next press
+    uint32_t press_tm = released_tm + 3000000000u;
+    for (uint32_t tm = press_tm; tm <= press_tm + DebouncedButton::DEBOUNCE_MS; ++tm)
+        idle.update(true, tm);
+    EXPECT_TRUE(idle.state());
+}
+
 /*---------------------------------------------------------------------------*/
 
 } // anonymous namespace
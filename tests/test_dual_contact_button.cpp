@@ -0,0 +1,136 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/DualContactButton.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestDualContactButton : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestDualContactButton, TestLatch)
+{
+    // Contacts read low when made
+    DualContactButton button(false);
+    uint32_t tm = 0;
+
+    // At rest the normally-closed contact is made
+    EXPECT_EQ(DebouncedButton::NONE, button.update(true, false, tm++));
+    EXPECT_FALSE(button.button().state());
+
+    // Travel breaks the normally-closed contact first, which changes nothing
+    EXPECT_EQ(DebouncedButton::NONE, button.update(true, true, tm++));
+    EXPECT_FALSE(button.button().state());
+
+    // The first make of the normally-open contact is a press
+    button.update(false, true, tm++);
+    EXPECT_TRUE(button.button().state());
+
+    // Bounces of the normally-open contact don't release it
+    for (int i = 0; i < 10; ++i) {
+        button.update(i & 1, true, tm++);
+        EXPECT_TRUE(button.button().state());
+    }
+
+    // The first make of the normally-closed contact is a release
+    button.update(true, false, tm++);
+    EXPECT_FALSE(button.button().state());
+    for (int i = 0; i < 10; ++i) {
+        button.update(true, i & 1, tm++);
+        EXPECT_FALSE(button.button().state());
+    }
+
+    // The short press is a click once the double click timeout passes
+    DebouncedButton::Input input = DebouncedButton::NONE;
+    for (uint32_t end_tm = tm + DebouncedButton::DOUBLE_CLICK_TIMEOUT_MS + 1; input == DebouncedButton::NONE && tm <= end_tm; ++tm)
+        input = button.update(true, false, tm);
+    EXPECT_EQ(DebouncedButton::CLICK, input);
+}
+
+TEST_F(TestDualContactButton, TestBankMatchesButtons)
+{
+    DualContactBank<uint16_t> bank(0x0000);
+    DualContactButton buttons[16];
+    for (int i = 0; i < 16; ++i)
+        buttons[i] = DualContactButton(false);
+
+    std::uniform_int_distribution<int> hold_ms(10, 400);
+    std::uniform_int_distribution<int> bounce(0, 1);
+    uint32_t change_tm[16] = {};
+    uint32_t next_change_tm[16] = {};
+    bool pressed[16] = {};
+
+    std::vector<std::vector<DebouncedButton::Input>> expected(16), actual(16);
+
+    for (uint32_t tm = 0; tm < 60000; ++tm) {
+        uint16_t no_readings = 0, nc_readings = 0;
+        for (int i = 0; i < 16; ++i) {
+            if (tm >= next_change_tm[i]) {
+                pressed[i] = !pressed[i];
+                change_tm[i] = tm;
+                next_change_tm[i] = tm + hold_ms(_rng);
+            }
+
+            // Both contacts are open for a few ms of travel, then the made
+            // contact bounces.
+            bool no_made = pressed[i], nc_made = !pressed[i];
+            uint32_t since = tm - change_tm[i];
+            if (tm > 0 && since < 3)
+                no_made = nc_made = false;
+            else if (since < 8 && bounce(_rng))
+                no_made = nc_made = false;
+
+            no_readings |= uint16_t(!no_made) << i;
+            nc_readings |= uint16_t(!nc_made) << i;
+
+            auto input = buttons[i].update(!no_made, !nc_made, tm);
+            if (input != DebouncedButton::NONE)
+                expected[i].push_back(input);
+        }
+
+        bank.update(no_readings, nc_readings, tm, [&](uint8_t i, DebouncedButton::Input input) {
+            actual[i].push_back(input);
+        });
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        SCOPED_TRACE("button " + std::to_string(i));
+        EXPECT_LT(50u, expected[i].size());
+        EXPECT_EQ(expected[i], actual[i]);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
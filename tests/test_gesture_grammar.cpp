@@ -0,0 +1,135 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/GestureGrammar.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+// The gestures recognized by DebouncedButton, in the order of its Input enum.
+constexpr char const* builtin_patterns[] = { ".", "..", "-", ".-", "..-" };
+constexpr auto builtin_table = compile_gestures<8>(builtin_patterns);
+static_assert(builtin_table.size == 6, "one node per distinct prefix");
+
+// Two ways to enter the same gesture share their final state.
+constexpr char const* alternative_patterns[] = { "-|.-", ".." };
+constexpr auto alternative_table = compile_gestures<8>(alternative_patterns);
+static_assert(alternative_table.size == 4, "equivalent leaves are merged");
+
+class TestGestureGrammar : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestGestureGrammar, TestMatchesBuiltinGestures)
+{
+    DebouncedButton button;
+    GestureMatcher<8> matcher(builtin_table);
+
+    std::uniform_int_distribution<uint32_t> hold_ms(button.DEBOUNCE_MS + 1, 2 * button.CLICKED_CUTOFF_MS);
+
+    std::vector<DebouncedButton::Input> expected;
+    std::vector<DebouncedButton::Input> actual;
+
+    uint32_t tm = 0;
+    auto hold = [&](bool reading, uint32_t ms) {
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            auto input = button.update(reading, tm);
+            if (input != DebouncedButton::NONE && input != DebouncedButton::RELEASE)
+                expected.push_back(input);
+            if (auto gesture = matcher.update(button, tm))
+                actual.push_back(DebouncedButton::Input(gesture));
+        }
+    };
+
+    for (int i = 0; i < 2000; ++i) {
+        hold(true, hold_ms(_rng));
+        hold(false, hold_ms(_rng));
+    }
+    hold(false, 1000);
+
+    EXPECT_LT(1000u, expected.size());
+    EXPECT_EQ(expected, actual);
+    EXPECT_FALSE(matcher.gesture_pending());
+}
+
+TEST_F(TestGestureGrammar, TestPatternSequences)
+{
+    constexpr static char const* patterns[] = { "-.-", "...", "-" };
+    constexpr static auto table = compile_gestures<8>(patterns);
+
+    DebouncedButton button;
+    GestureMatcher<8> matcher(table);
+
+    uint32_t short_ms = button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS / 2;
+    uint32_t long_ms = button.DEBOUNCE_MS + button.CLICKED_CUTOFF_MS + 10;
+
+    uint32_t tm = 0;
+    auto hold = [&](bool reading, uint32_t ms) {
+        uint8_t result = 0;
+        for (uint32_t end_tm = tm + ms; tm < end_tm; ++tm) {
+            button.update(reading, tm);
+            if (auto gesture = matcher.update(button, tm))
+                result = gesture;
+        }
+        return result;
+    };
+
+    // The final long press completes the pattern while still held
+    EXPECT_EQ(0, hold(true, long_ms));
+    EXPECT_EQ(0, hold(false, short_ms));
+    EXPECT_EQ(0, hold(true, short_ms));
+    EXPECT_EQ(0, hold(false, short_ms));
+    EXPECT_EQ(1, hold(true, long_ms));
+    EXPECT_FALSE(matcher.gesture_pending());
+    EXPECT_EQ(0, hold(false, 1000));
+
+    // A long press alone is delivered once the double click timeout passes
+    EXPECT_EQ(0, hold(true, long_ms));
+    EXPECT_TRUE(matcher.gesture_pending());
+    EXPECT_EQ(3, hold(false, 1000));
+
+    // Three short presses end in a leaf and are delivered on release
+    EXPECT_EQ(0, hold(true, short_ms));
+    EXPECT_EQ(0, hold(false, short_ms));
+    EXPECT_EQ(0, hold(true, short_ms));
+    EXPECT_EQ(0, hold(false, short_ms));
+    EXPECT_EQ(0, hold(true, short_ms));
+    EXPECT_EQ(2, hold(false, button.DEBOUNCE_MS + 1));
+
+    // Sequences that match no pattern deliver nothing
+    EXPECT_EQ(0, hold(true, short_ms));
+    EXPECT_EQ(0, hold(false, 1000));
+    EXPECT_FALSE(matcher.gesture_pending());
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
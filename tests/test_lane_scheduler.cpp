@@ -0,0 +1,107 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+
+#include "../src/LaneScheduler.h"
+#include "../src/VerticalCounter.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+TEST(TestLaneScheduler, TestCounterBits)
+{
+    // 2^bits samples span 2^bits - 1 periods
+    EXPECT_EQ(3, counter_bits_for(20, 5));
+    EXPECT_EQ(2, counter_bits_for(20, 10));
+    EXPECT_EQ(2, counter_bits_for(30, 10));
+    EXPECT_EQ(3, counter_bits_for(31, 10));
+    EXPECT_EQ(1, counter_bits_for(5, 10));
+    EXPECT_EQ(5, counter_bits_for(20, 1));
+}
+
+TEST(TestLaneScheduler, TestPeriodsAndJitter)
+{
+    LaneScheduler<2> scheduler({ 1, 10 });
+    uint32_t scans[2] = {};
+
+    for (uint32_t tm = 0; tm < 1000; ++tm)
+        scheduler.update(tm, [&](uint8_t lane, uint32_t) { ++scans[lane]; });
+    EXPECT_EQ(1000u, scans[0]);
+    EXPECT_EQ(100u, scans[1]);
+    EXPECT_EQ(0u, scheduler.stats(0).max_jitter_ms);
+    EXPECT_EQ(0u, scheduler.stats(1).max_jitter_ms);
+
+    uint32_t deadline_tm;
+    scheduler.next_deadline(deadline_tm);
+    EXPECT_EQ(1000u, deadline_tm);
+
+    // A 4ms stall makes the fast lane miss scans and the slow lane late
+    scheduler.reset_stats(0);
+    scheduler.reset_stats(1);
+    scheduler.update(1004, [&](uint8_t lane, uint32_t) { ++scans[lane]; });
+    EXPECT_EQ(1u, scheduler.stats(0).scans);
+    EXPECT_EQ(4u, scheduler.stats(0).missed);
+    EXPECT_EQ(4u, scheduler.stats(0).max_jitter_ms);
+    EXPECT_EQ(4u, scheduler.stats(1).last_jitter_ms);
+    EXPECT_EQ(0u, scheduler.stats(1).missed);
+
+    // And the slow lane stays on its own schedule afterward
+    for (uint32_t tm = 1005; tm < 1100; ++tm)
+        scheduler.update(tm, [&](uint8_t lane, uint32_t) { ++scans[lane]; });
+    EXPECT_EQ(10u, scheduler.stats(1).scans);
+    EXPECT_EQ(0u, scheduler.stats(1).last_jitter_ms);
+}
+
+TEST(TestLaneScheduler, TestLanesOfButtons)
+{
+    // A stop switch scanned every millisecond, and a panel every 10 with
+    // counters sized for the same 20ms debounce period
+    const uint32_t PANEL_MS = 10;
+    LaneScheduler<2> scheduler({ 1, PANEL_MS });
+    DebouncedButton stop;
+    VerticalCounterBank<uint8_t, counter_bits_for(DebouncedButton::DEBOUNCE_MS, PANEL_MS)> panel;
+
+    uint32_t stop_tm = 0, panel_tm = 0;
+    for (uint32_t tm = 0; tm < 300; ++tm) {
+        bool pressed = tm >= 100;
+        scheduler.update(tm, [&](uint8_t lane, uint32_t tm) {
+            if (lane == 0) {
+                stop.update(pressed, tm);
+                if (stop.state() && !stop_tm)
+                    stop_tm = tm;
+            } else {
+                panel.update(pressed ? 0x01 : 0x00, tm, [](uint8_t, DebouncedButton::Input) { });
+                if (panel.state() && !panel_tm)
+                    panel_tm = tm;
+            }
+        });
+    }
+
+    EXPECT_EQ(100 + DebouncedButton::DEBOUNCE_MS, stop_tm);
+    // The panel's 2-bit counters change state on the fourth sample, 30ms on
+    EXPECT_EQ(100 + 3 * PANEL_MS, panel_tm);
+    EXPECT_LE(100 + DebouncedButton::DEBOUNCE_MS, panel_tm);
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
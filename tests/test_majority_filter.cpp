@@ -0,0 +1,82 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "../src/MajorityFilter.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestMajorityFilter : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestMajorityFilter, TestMajorityLevel)
+{
+    EXPECT_FALSE(majority_level(uint8_t(0x00), 5));
+    EXPECT_FALSE(majority_level(uint8_t(0x0f), 5));
+    EXPECT_TRUE(majority_level(uint8_t(0x1f), 5));
+    EXPECT_TRUE(majority_level(uint32_t(0xffff0001), 17));
+    EXPECT_FALSE(majority_level(uint32_t(0xffff0000), 17));
+    EXPECT_TRUE(majority_level(uint64_t(0x8000000000000000), 1));
+}
+
+TEST_F(TestMajorityFilter, TestSpikesRejected)
+{
+    OversampledButton<uint16_t> button;
+
+    // Up to 7 of 16 samples flipped by noise never reach the button
+    std::uniform_int_distribution<int> bit(0, 15);
+    std::uniform_int_distribution<int> flips(0, 7);
+    auto noisy = [&](uint16_t level) {
+        uint16_t noise = 0;
+        for (int i = flips(_rng); i > 0; --i)
+            noise |= 1 << bit(_rng);
+        return uint16_t(level ^ noise);
+    };
+
+    uint32_t tm = 0;
+    for (; tm < 1000; ++tm) {
+        EXPECT_EQ(DebouncedButton::NONE, button.update(noisy(0x0000), tm));
+        EXPECT_FALSE(button.button().debouncing());
+    }
+
+    // A real press is seen despite the noise
+    for (; tm < 1000 + DebouncedButton::DEBOUNCE_MS; ++tm)
+        button.update(noisy(0xffff), tm);
+    EXPECT_FALSE(button.button().state());
+    button.update(noisy(0xffff), tm++);
+    EXPECT_TRUE(button.button().state());
+    EXPECT_TRUE(button.button().input_pending());
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,94 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../src/MorseDecoder.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestMorseDecoder : public testing::Test
+{
+protected:
+    DebouncedButton _button;
+    MorseDecoder _decoder;
+    uint32_t _tm = 0;
+    std::string _decoded;
+
+    void hold(bool reading, uint32_t ms)
+    {
+        for (uint32_t end_tm = _tm + ms; _tm < end_tm; ++_tm) {
+            _button.update(reading, _tm);
+            if (char symbol = _decoder.update(_button, _tm))
+                _decoded += symbol;
+        }
+    }
+
+    // Taps out a sequence of dots and dashes, with spaces between symbols
+    // and slashes between words.
+    void tap(char const* code)
+    {
+        uint32_t dot_ms = _button.DEBOUNCE_MS + MorseDecoder::DASH_MS / 2;
+        uint32_t dash_ms = _button.DEBOUNCE_MS + 2 * MorseDecoder::DASH_MS;
+        uint32_t element_gap_ms = _button.DEBOUNCE_MS + MorseDecoder::LETTER_GAP_MS / 4;
+
+        for (char const* p = code; *p; ++p) {
+            if (*p == '.' || *p == '-') {
+                hold(true, *p == '.' ? dot_ms : dash_ms);
+                hold(false, element_gap_ms);
+            } else if (*p == ' ') {
+                hold(false, MorseDecoder::LETTER_GAP_MS);
+            } else if (*p == '/') {
+                hold(false, MorseDecoder::WORD_GAP_MS);
+            }
+        }
+    }
+};
+
+TEST_F(TestMorseDecoder, TestLettersAndWords)
+{
+    tap("... --- ... / -.- ..--- /");
+    EXPECT_EQ("SOS K2 ", _decoded);
+    EXPECT_FALSE(_decoder.symbol_pending());
+}
+
+TEST_F(TestMorseDecoder, TestUnknownSequences)
+{
+    // Valid length but unassigned, and longer than any symbol in the tree
+    tap("..-- ........ .-");
+    hold(false, MorseDecoder::LETTER_GAP_MS);
+    EXPECT_EQ("??A", _decoded);
+}
+
+TEST_F(TestMorseDecoder, TestReset)
+{
+    tap("-");
+    EXPECT_TRUE(_decoder.symbol_pending());
+    _decoder.reset();
+    EXPECT_FALSE(_decoder.symbol_pending());
+    tap("... /");
+    EXPECT_EQ("S ", _decoded);
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,128 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../src/ScanRateController.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+TEST(TestScanRateController, TestIdleAndActive)
+{
+    ScanRateController rate;
+    DebouncedButton button;
+    std::vector<uint32_t> scan_tms;
+    std::vector<DebouncedButton::Input> inputs;
+
+    auto run = [&](uint32_t end_tm, uint32_t press_tm, uint32_t release_tm) {
+        for (uint32_t tm = scan_tms.empty() ? 0 : scan_tms.back() + 1; tm < end_tm; ++tm) {
+            if (!rate.scan_due(tm))
+                continue;
+            scan_tms.push_back(tm);
+            rate.begin_scan();
+            auto input = button.update(tm >= press_tm && tm < release_tm, tm);
+            if (input != DebouncedButton::NONE)
+                inputs.push_back(input);
+            rate.observe(button);
+            rate.end_scan(tm);
+        }
+    };
+
+    // Idle scans at the idle period
+    run(1001, UINT32_MAX, UINT32_MAX);
+    EXPECT_EQ(21u, rate.scans());
+    EXPECT_EQ(21u * 49, rate.scans_saved());
+    EXPECT_FALSE(rate.active());
+
+    // A press is seen within the idle period, then scanned at full rate
+    uint32_t const press_tm = 1010, release_tm = 1090;
+    uint32_t first_scan = scan_tms.size();
+    run(2000, press_tm, release_tm);
+    EXPECT_EQ(std::vector<DebouncedButton::Input>({ DebouncedButton::CLICK }), inputs);
+    EXPECT_EQ(1050u, scan_tms[first_scan]);
+    EXPECT_GE(rate.max_first_edge_latency_ms(), scan_tms[first_scan] - press_tm);
+
+    uint32_t fast_scans = 0;
+    for (size_t i = first_scan + 1; i < scan_tms.size(); ++i)
+        fast_scans += scan_tms[i] - scan_tms[i - 1] == 1;
+    EXPECT_LT(200u, fast_scans);
+
+    // And the scan rate drops back once the click is delivered
+    EXPECT_FALSE(rate.active());
+    EXPECT_EQ(50u, scan_tms.back() - scan_tms[scan_tms.size() - 2]);
+
+    // A wake makes a scan due at once
+    rate.wake(scan_tms.back() + 1);
+    EXPECT_TRUE(rate.scan_due(scan_tms.back() + 1));
+}
+
+TEST(TestScanRateController, TestShortIdlePeriod)
+{
+    // An idle period shorter than the active one is taken as the active one,
+    // so idle scans save nothing instead of wrapping the count
+    ScanRateController rate(0, 5);
+    EXPECT_EQ(5u, rate.max_first_edge_latency_ms());
+    for (uint32_t tm = 0; tm < 100; ++tm) {
+        if (!rate.scan_due(tm))
+            continue;
+        rate.begin_scan();
+        rate.end_scan(tm);
+    }
+    EXPECT_EQ(20u, rate.scans());
+    EXPECT_EQ(0u, rate.scans_saved());
+}
+
+TEST(TestScanRateController, TestDeadlines)
+{
+    // A speculative click is confirmed on time even though the button is
+    // otherwise idle
+    DebouncedButton::Profile speculative = DebouncedButton::profile(0);
+    speculative.flags = DebouncedButton::SPECULATIVE_CLICK;
+    DebouncedButton::set_profile(1, speculative);
+
+    ScanRateController rate;
+    DebouncedButton button(true, 1);
+    uint32_t confirmed_tm = 0, release_accepted_tm = 0;
+
+    for (uint32_t tm = 0; tm < 1000; ++tm) {
+        if (!rate.scan_due(tm))
+            continue;
+        rate.begin_scan();
+        auto input = button.update(tm >= 100 && tm < 150, tm);
+        if (input == DebouncedButton::CLICK)
+            release_accepted_tm = tm;
+        if (input == DebouncedButton::CLICK_CONFIRMED)
+            confirmed_tm = tm;
+        rate.observe(button);
+        rate.end_scan(tm);
+    }
+
+    EXPECT_EQ(150u + DebouncedButton::DEBOUNCE_MS, release_accepted_tm);
+    EXPECT_EQ(release_accepted_tm + DebouncedButton::DOUBLE_CLICK_TIMEOUT_MS + 1, confirmed_tm);
+
+    DebouncedButton::reset_profiles();
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,124 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/SlicedScanner.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestSlicedScanner : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestSlicedScanner, TestMatchesFullRateButtons)
+{
+    // A large bank swept every 10 ticks, in which a scattering of buttons is
+    // pressed with holds and gaps clear of the timing thresholds by more
+    // than a sweep.
+    const uint32_t SIZE = 50000;
+    const int ACTIVE = 40;
+    using Scanner = SlicedScanner<SIZE>;
+    std::unique_ptr<Scanner> scanner(new Scanner(10));
+    EXPECT_EQ(5000u, scanner->slice());
+
+    // A sweep of no ticks is taken as one
+    EXPECT_EQ(64u, (SlicedScanner<64>(0).slice()));
+
+    std::uniform_int_distribution<uint32_t> index(0, SIZE - 1);
+    std::vector<uint32_t> active;
+    while (active.size() < ACTIVE) {
+        uint32_t i = index(_rng);
+        if (std::find(active.begin(), active.end(), i) == active.end())
+            active.push_back(i);
+    }
+
+    uint32_t const hold_choices[] = { 40, 70, 100, 220, 300 };
+    std::uniform_int_distribution<int> hold_choice(0, 4);
+    std::vector<uint32_t> next_change_tm(ACTIVE, 0);
+    std::vector<bool> readings(SIZE, false);
+    std::vector<DebouncedButton> buttons(ACTIVE);
+
+    std::vector<std::vector<DebouncedButton::Input>> expected(ACTIVE), actual(ACTIVE);
+    auto slot = [&](uint32_t i) { return std::find(active.begin(), active.end(), i) - active.begin(); };
+
+    uint16_t max_lane = 0;
+    for (uint32_t tm = 0; tm < 20000; ++tm) {
+        for (int a = 0; a < ACTIVE; ++a) {
+            if (tm >= next_change_tm[a] && tm < 19000) {
+                readings[active[a]] = !readings[active[a]];
+                next_change_tm[a] = tm + hold_choices[hold_choice(_rng)];
+            } else if (tm >= 19000) {
+                readings[active[a]] = false;
+            }
+            auto input = buttons[a].update(readings[active[a]], tm);
+            if (input != DebouncedButton::NONE)
+                expected[a].push_back(input);
+        }
+
+        scanner->update(tm, [&](uint32_t i) { return readings[i]; },
+                        [&](uint32_t i, DebouncedButton::Input input) {
+                            actual[slot(i)].push_back(input);
+                        });
+        max_lane = std::max(max_lane, scanner->lane_size());
+    }
+
+    for (int a = 0; a < ACTIVE; ++a) {
+        SCOPED_TRACE("button " + std::to_string(active[a]));
+        EXPECT_LT(20u, expected[a].size());
+        EXPECT_EQ(expected[a], actual[a]);
+    }
+    EXPECT_LT(0, max_lane);
+    EXPECT_GE(ACTIVE, max_lane);
+    EXPECT_EQ(0u, scanner->lane_overflows());
+    EXPECT_EQ(0, scanner->lane_size());
+}
+
+TEST_F(TestSlicedScanner, TestLaneOverflow)
+{
+    // Buttons that find the lane full are still swept
+    SlicedScanner<64, 4> scanner(4);
+    std::vector<DebouncedButton::Input> inputs;
+    for (uint32_t tm = 0; tm < 400; ++tm) {
+        scanner.update(tm, [&](uint32_t) { return tm < 100; },
+                       [&](uint32_t, DebouncedButton::Input input) { inputs.push_back(input); });
+        EXPECT_GE(4, scanner.lane_size());
+    }
+    EXPECT_LT(0u, scanner.lane_overflows());
+    EXPECT_EQ(64u, inputs.size());
+    EXPECT_EQ(0, scanner.lane_size());
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,192 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/SparseBank.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestSparseBank : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestSparseBank, TestMatchesButtons)
+{
+    const uint32_t SIZE = 20000;
+    const int ACTIVE = 64;
+    using Bank = SparseBank<SIZE>;
+    std::unique_ptr<Bank> bank(new Bank);
+    EXPECT_TRUE(bank->idle());
+
+    // Bouncing presses on a scattering of buttons, some sharing words
+    std::uniform_int_distribution<uint32_t> index(0, SIZE - 1);
+    std::vector<uint32_t> active;
+    for (int a = 0; a < ACTIVE; ++a)
+        active.push_back(a % 4 ? index(_rng) : active.empty() ? 0 : active.back() + 1);
+
+    std::uniform_int_distribution<int> hold_ms(10, 400);
+    std::uniform_int_distribution<int> bounce(0, 3);
+    std::vector<uint32_t> change_tm(ACTIVE, 0), next_change_tm(ACTIVE, 0);
+    std::vector<bool> pressed(ACTIVE, false);
+    std::vector<DebouncedButton> buttons(ACTIVE);
+    std::vector<std::vector<DebouncedButton::Input>> expected(ACTIVE), actual(SIZE);
+
+    for (uint32_t tm = 0; tm < 20000; ++tm) {
+        for (int a = 0; a < ACTIVE; ++a) {
+            if (tm >= next_change_tm[a] && tm < 19000) {
+                pressed[a] = !pressed[a];
+                change_tm[a] = tm;
+                next_change_tm[a] = tm + hold_ms(_rng);
+            } else if (tm >= 19000) {
+                pressed[a] = false;
+            }
+            bool reading = pressed[a];
+            if (tm - change_tm[a] < 5 && bounce(_rng) == 0)
+                reading = !reading;
+
+            bank->set_reading(active[a], reading);
+            auto input = buttons[a].update(reading, tm);
+            if (input != DebouncedButton::NONE)
+                expected[a].push_back(input);
+        }
+
+        bank->update(tm, [&](uint32_t i, DebouncedButton::Input input) {
+            actual[i].push_back(input);
+        });
+    }
+
+    for (int a = 0; a < ACTIVE; ++a) {
+        SCOPED_TRACE("button " + std::to_string(active[a]));
+        EXPECT_LT(20u, expected[a].size());
+        EXPECT_EQ(expected[a], actual[active[a]]);
+    }
+    EXPECT_TRUE(bank->idle());
+}
+
+TEST_F(TestSparseBank, TestActiveMarks)
+{
+    SparseBank<8192> bank;
+    auto none = [](uint32_t, DebouncedButton::Input) { };
+
+    // Setting the same reading doesn't mark a button
+    bank.set_reading(5000, false);
+    EXPECT_FALSE(bank.active(5000));
+
+    // A press stays active until its click is delivered, then is dropped
+    bank.set_reading(5000, true);
+    EXPECT_TRUE(bank.active(5000));
+    uint32_t tm = 0;
+    for (; tm < 50; ++tm)
+        bank.update(tm, none);
+    EXPECT_TRUE(bank.active(5000));
+    bank.set_reading(5000, false);
+    for (; tm < 1000; ++tm)
+        bank.update(tm, none);
+    EXPECT_FALSE(bank.active(5000));
+    EXPECT_TRUE(bank.idle());
+
+    // A bounce that returns to the debounced reading is dropped at once
+    bank.set_reading(8191, true);
+    bank.set_reading(8191, false);
+    EXPECT_TRUE(bank.active(8191));
+    bank.update(tm++, none);
+    EXPECT_FALSE(bank.active(8191));
+}
+
+TEST_F(TestSparseBank, TestBulkQueries)
+{
+    using Bank = SparseBank<10000>;
+    Bank bank;
+    auto none = [](uint32_t, DebouncedButton::Input) { };
+    uint64_t pressed[Bank::WORDS], pending[Bank::WORDS], changed[Bank::WORDS], group[Bank::WORDS] = {};
+
+    // A chord of buttons 100 and 9000
+    group[100 / 64] |= uint64_t(1) << (100 % 64);
+    group[9000 / 64] |= uint64_t(1) << (9000 % 64);
+
+    uint32_t tm = 0;
+    bank.set_reading(100, true);
+    for (; tm < 100; ++tm)
+        bank.update(tm, none);
+    bank.pressed_mask(pressed);
+    EXPECT_TRUE(any_of(pressed, group));
+    EXPECT_FALSE(all_of(pressed, group));
+
+    bank.set_reading(9000, true);
+    for (; tm < 300; ++tm)
+        bank.update(tm, none);
+    bank.pressed_mask(pressed);
+    bank.pending_mask(pending);
+    EXPECT_TRUE(all_of(pressed, group));
+    EXPECT_FALSE(any_of(pending, group));
+
+    bank.changed_since(100, changed);
+    EXPECT_EQ(uint64_t(1) << (9000 % 64), changed[9000 / 64]);
+    EXPECT_EQ(0u, changed[100 / 64]);
+    bank.changed_since(0, changed);
+    EXPECT_TRUE(all_of(changed, group));
+
+    // A click on button 100 is pending until its timeout
+    bank.set_reading(100, false);
+    bank.set_reading(9000, false);
+    for (uint32_t end_tm = tm + 30; tm < end_tm; ++tm)
+        bank.update(tm, none);
+    bank.set_reading(100, true);
+    for (uint32_t end_tm = tm + 50; tm < end_tm; ++tm)
+        bank.update(tm, none);
+    bank.set_reading(100, false);
+    for (uint32_t end_tm = tm + 50; tm < end_tm; ++tm)
+        bank.update(tm, none);
+    bank.pending_mask(pending);
+    EXPECT_EQ(uint64_t(1) << (100 % 64), pending[100 / 64]);
+    for (uint32_t end_tm = tm + 200; tm < end_tm; ++tm)
+        bank.update(tm, none);
+    bank.pending_mask(pending);
+    EXPECT_EQ(0u, pending[100 / 64]);
+
+    // Changes older than the horizon are forgotten, so they don't look
+    // recent once the time is 2^31 ms or more past them
+    for (; tm < (uint32_t(3) << 30); tm += uint32_t(1) << 26)
+        bank.update(tm, none);
+    bank.set_reading(5000, true);
+    for (uint32_t end_tm = tm + 30; tm < end_tm; ++tm)
+        bank.update(tm, none);
+    bank.changed_since(tm - Bank::CHANGE_HORIZON_MS / 2, changed);
+    EXPECT_EQ(uint64_t(1) << (5000 % 64), changed[5000 / 64]);
+    EXPECT_EQ(0u, changed[100 / 64]);
+    EXPECT_EQ(0u, changed[9000 / 64]);
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,95 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/SplitBank.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestSplitBank : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestSplitBank, TestMatchesButtons)
+{
+    // Start once from 0 and once shortly before the clock rolls over
+    for (uint32_t start_tm : { uint32_t(0), UINT32_MAX - 10000 }) {
+        SCOPED_TRACE("start " + std::to_string(start_tm));
+
+        const uint32_t SIZE = 300;
+        using Bank = SplitBank<SIZE>;
+        Bank bank;
+        std::vector<DebouncedButton> buttons(SIZE);
+
+        std::uniform_int_distribution<int> hold_ms(10, 400);
+        std::uniform_int_distribution<int> bounce(0, 3);
+        std::vector<uint32_t> change_tick(SIZE, 0), next_change_tick(SIZE, 0);
+        std::vector<bool> pressed(SIZE, false);
+        std::vector<std::vector<DebouncedButton::Input>> expected(SIZE), actual(SIZE);
+
+        for (uint32_t tick = 0; tick < 20000; ++tick) {
+            uint32_t tm = start_tm + tick;
+            uint64_t readings[Bank::WORDS] = {};
+            for (uint32_t b = 0; b < SIZE; ++b) {
+                if (tick >= next_change_tick[b] && tick < 19000) {
+                    pressed[b] = !pressed[b];
+                    change_tick[b] = tick;
+                    next_change_tick[b] = tick + hold_ms(_rng);
+                } else if (tick >= 19000) {
+                    pressed[b] = false;
+                }
+                bool reading = pressed[b];
+                if (tick - change_tick[b] < 5 && bounce(_rng) == 0)
+                    reading = !reading;
+                readings[b / 64] |= uint64_t(reading) << (b % 64);
+
+                auto input = buttons[b].update(reading, tm);
+                if (input != DebouncedButton::NONE)
+                    expected[b].push_back(input);
+            }
+
+            bank.update(readings, tm, [&](uint32_t b, DebouncedButton::Input input) {
+                actual[b].push_back(input);
+            });
+        }
+
+        for (uint32_t b = 0; b < SIZE; ++b) {
+            SCOPED_TRACE("button " + std::to_string(b));
+            EXPECT_LT(20u, expected[b].size());
+            EXPECT_EQ(expected[b], actual[b]);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,147 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "../src/VelocityKeyScanner.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+using Scanner = VelocityKeyScanner<88>;
+using Note = std::pair<uint16_t, uint8_t>;
+
+TEST(TestVelocityKeyScanner, TestVelocityCurve)
+{
+    Scanner scanner;
+    EXPECT_EQ(127, scanner.velocity(0));
+    EXPECT_EQ(127, scanner.velocity(Scanner::MIN_STRIKE_TM));
+    EXPECT_EQ(1, scanner.velocity(Scanner::MAX_STRIKE_TM));
+    EXPECT_EQ(1, scanner.velocity(10 * Scanner::MAX_STRIKE_TM));
+
+    // Slower strikes are never louder
+    uint8_t prev = 127;
+    for (uint32_t t = Scanner::MIN_STRIKE_TM; t < Scanner::MAX_STRIKE_TM; t += 100) {
+        uint8_t v = scanner.velocity(t);
+        EXPECT_LE(v, prev);
+        EXPECT_LE(1, v);
+        prev = v;
+    }
+    EXPECT_GT(20, scanner.velocity(Scanner::MAX_STRIKE_TM / 2));
+
+    // The table steps are even in log(strike time), so fast strikes, where
+    // the curve is steep, still get many distinct velocities
+    std::set<uint8_t> velocities;
+    for (uint32_t t = Scanner::MIN_STRIKE_TM; t <= Scanner::MAX_STRIKE_TM; t += 10)
+        velocities.insert(scanner.velocity(t));
+    EXPECT_LE(36u, velocities.size());
+    EXPECT_EQ(0, scanner.step(Scanner::MIN_STRIKE_TM));
+    EXPECT_GT(Scanner::VELOCITY_STEPS, scanner.step(Scanner::MAX_STRIKE_TM));
+
+    // The table can be refilled from the strike time of each step
+    for (uint8_t i = 0; i < Scanner::VELOCITY_STEPS; ++i)
+        scanner.velocity_table()[i] = i + 1;
+    for (uint8_t i = 1; i < scanner.step(Scanner::MAX_STRIKE_TM); ++i) {
+        EXPECT_EQ(i, scanner.step(scanner.step_tm(i)));
+        EXPECT_EQ(i + 1, scanner.velocity(scanner.step_tm(i)));
+    }
+}
+
+TEST(TestVelocityKeyScanner, TestStrikes)
+{
+    // Contacts read low when closed
+    Scanner scanner(false);
+    uint32_t first[Scanner::WORDS], second[Scanner::WORDS];
+    std::vector<Note> notes;
+    auto on_key = [&](uint16_t key, uint8_t velocity) { notes.emplace_back(key, velocity); };
+
+    auto scan = [&](uint32_t tm, std::vector<uint16_t> firsts, std::vector<uint16_t> seconds) {
+        for (int w = 0; w < Scanner::WORDS; ++w)
+            first[w] = second[w] = ~uint32_t(0);
+        for (auto key : firsts)
+            first[key / 32] &= ~(uint32_t(1) << (key % 32));
+        for (auto key : seconds)
+            second[key / 32] &= ~(uint32_t(1) << (key % 32));
+        scanner.update(first, second, tm, on_key);
+    };
+
+    uint32_t tm = 0;
+    scan(tm, {}, {});
+    EXPECT_TRUE(notes.empty());
+
+    // A fast strike of key 87 and a slow one of key 3, with the first
+    // contact of key 3 bouncing
+    scan(tm += 100, { 87, 3 }, {});
+    scan(tm += 100, { 87 }, {});
+    scan(tm += 100, { 87, 3 }, {});
+    scan(tm += 800, { 87, 3 }, { 87 });
+    EXPECT_EQ(std::vector<Note>({ { 87, 127 } }), notes);
+    EXPECT_TRUE(scanner.down(87));
+    EXPECT_FALSE(scanner.down(3));
+
+    scan(tm += 49000, { 87, 3 }, { 87, 3 });
+    ASSERT_EQ(2u, notes.size());
+    EXPECT_EQ(3, notes[1].first);
+    EXPECT_EQ(scanner.velocity(50000), notes[1].second);
+
+    // Bounces of the second contact don't strike again, and keys are
+    // released once both contacts open
+    scan(tm += 100, { 87, 3 }, { 3 });
+    scan(tm += 100, { 87, 3 }, { 87, 3 });
+    scan(tm += 100, { 3 }, {});
+    scan(tm += 100, {}, {});
+    EXPECT_EQ(std::vector<Note>({ { 87, 127 }, notes[1], { 87, 0 }, { 3, 0 } }), notes);
+
+    // A key that's touched but not struck is disarmed after the slowest
+    // strike time, so the next strike is timed from its own first contact
+    notes.clear();
+    scan(tm += 100, { 40 }, {});
+    scan(tm += 100, {}, {});
+    scan(tm += Scanner::MAX_STRIKE_TM, {}, {});
+    scan(tm += 100, { 40 }, {});
+    scan(tm += Scanner::MIN_STRIKE_TM, { 40 }, { 40 });
+    EXPECT_EQ(std::vector<Note>({ { 40, 127 } }), notes);
+    scan(tm += 100, {}, {});
+
+    // Strikes are timed across clock rollover
+    notes.clear();
+    tm = UINT32_MAX - 50;
+    scan(tm, { 50 }, {});
+    scan(tm += Scanner::MIN_STRIKE_TM, { 50 }, { 50 });
+    scan(tm += 100, {}, {});
+    EXPECT_EQ(std::vector<Note>({ { 50, 127 }, { 50, 0 } }), notes);
+
+    // A key resting on its first contact for longer than half the clock
+    // period is still struck at the slowest velocity
+    notes.clear();
+    scan(tm += 100, { 60 }, {});
+    for (int i = 0; i < 3; ++i)
+        scan(tm += uint32_t(1) << 30, { 60 }, {});
+    scan(tm += 100, { 60 }, { 60 });
+    EXPECT_EQ(std::vector<Note>({ { 60, 1 } }), notes);
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace
@@ -0,0 +1,177 @@
+/*
+    Copyright 2023 Zach Vonler <zvonler@gmail.com>
+
+    This file is part of DebouncedButton.
+
+    DebouncedButton is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the Free
+    Software Foundation, either version 3 of the License, or (at your option)
+    any later version.
+
+    DebouncedButton is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details.
+
+    You should have received a copy of the GNU General Public License along with
+    DebouncedButton.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../src/VerticalCounter.h"
+
+namespace {
+
+/*---------------------------------------------------------------------------*/
+
+class TestVerticalCounter : public testing::Test
+{
+protected:
+    std::mt19937 _rng;
+
+    void SetUp() override
+    {
+        _rng.seed(123456);
+    }
+};
+
+TEST_F(TestVerticalCounter, TestCounter)
+{
+    VerticalCounter<uint8_t> counter;
+
+    // Bit 0 changes on the fourth sample in a row
+    EXPECT_EQ(0, counter.update(0x01));
+    EXPECT_EQ(0, counter.update(0x01));
+    EXPECT_EQ(0, counter.update(0x01));
+    EXPECT_EQ(0x01, counter.update(0x01));
+    EXPECT_EQ(0x01, counter.state());
+
+    // A glitch restarts the count for bit 1
+    EXPECT_EQ(0, counter.update(0x03));
+    EXPECT_EQ(0, counter.update(0x03));
+    EXPECT_EQ(0, counter.update(0x01));
+    EXPECT_EQ(0, counter.update(0x03));
+    EXPECT_EQ(0, counter.update(0x03));
+    EXPECT_EQ(0, counter.update(0x03));
+    EXPECT_EQ(0x02, counter.update(0x03));
+    EXPECT_EQ(0x03, counter.state());
+
+    // Both change together
+    EXPECT_EQ(0, counter.update(0x00));
+    EXPECT_EQ(0, counter.update(0x00));
+    EXPECT_EQ(0, counter.update(0x00));
+    EXPECT_EQ(0x03, counter.update(0x00));
+    EXPECT_EQ(0x00, counter.state());
+
+    // Wider counters take longer
+    VerticalCounter<uint64_t, 3> wide;
+    for (int i = 0; i < 7; ++i)
+        EXPECT_EQ(0u, wide.update(uint64_t(1) << 63));
+    EXPECT_EQ(uint64_t(1) << 63, wide.update(uint64_t(1) << 63));
+}
+
+TEST_F(TestVerticalCounter, TestBulkQueries)
+{
+    VerticalCounterBank<uint8_t> bank;
+    auto none = [](uint8_t, DebouncedButton::Input) { };
+
+    // Buttons 0 and 3 are pressed on the fourth sample
+    uint32_t tm = 0;
+    for (; tm < 4; ++tm)
+        bank.update(0x09, tm, none);
+    EXPECT_EQ(0x09, bank.pressed_mask());
+    EXPECT_EQ(0x09, bank.pending_mask());
+    EXPECT_EQ(0x09, bank.changed_since(3));
+    EXPECT_EQ(0, bank.changed_since(4));
+
+    EXPECT_TRUE(any_of(bank.pressed_mask(), uint8_t(0x0c)));
+    EXPECT_FALSE(all_of(bank.pressed_mask(), uint8_t(0x0c)));
+    EXPECT_TRUE(all_of(bank.pressed_mask(), uint8_t(0x09)));
+
+    // Button 3 is released, and button 0 becomes a long press
+    for (; tm < 50; ++tm)
+        bank.update(0x09, tm, none);
+    for (; tm < 400; ++tm)
+        bank.update(0x01, tm, none);
+    EXPECT_EQ(0x01, bank.pressed_mask());
+    EXPECT_EQ(0, bank.pending_mask());
+    EXPECT_EQ(0x08, bank.changed_since(50));
+    EXPECT_EQ(0x09, bank.changed_since(0));
+
+    // Changes older than the horizon are forgotten, so they don't look
+    // recent once the time is 2^31 ms or more past them
+    for (; tm < (uint32_t(3) << 30); tm += uint32_t(1) << 26)
+        bank.update(0x01, tm, none);
+    for (uint32_t end_tm = tm + 4; tm < end_tm; ++tm)
+        bank.update(0x05, tm, none);
+    EXPECT_EQ(0x05, bank.pressed_mask());
+    EXPECT_EQ(0x04, bank.changed_since(tm - ButtonBank<uint8_t>::CHANGE_HORIZON_MS / 2));
+}
+
+TEST_F(TestVerticalCounter, TestBankMatchesButtons)
+{
+    // Compare against buttons whose debounce period matches the counters'
+    // four samples, with presses and gaps clear of the timing thresholds.
+    DebouncedButton::Profile matching = DebouncedButton::profile(0);
+    matching.debounce_ms = matching.min_debounce_ms = 3;
+    DebouncedButton::set_profile(1, matching);
+
+    // Start once from 0 and once shortly before the clock rolls over
+    for (uint32_t start_tm : { uint32_t(0), UINT32_MAX - 30000 }) {
+        SCOPED_TRACE("start " + std::to_string(start_tm));
+
+        // Active-low buttons in the low half of the word
+        VerticalCounterBank<uint32_t> bank(0xffff0000);
+        DebouncedButton buttons[32];
+        for (int i = 0; i < 32; ++i)
+            buttons[i] = DebouncedButton(i >= 16, 1);
+
+        uint32_t const hold_choices[] = { 30, 60, 100, 200, 300 };
+        std::uniform_int_distribution<int> hold_choice(0, 4);
+        auto hold_ms = [&](std::mt19937& rng) { return hold_choices[hold_choice(rng)]; };
+        uint32_t next_change_tick[32] = {};
+        bool pressed[32] = {};
+
+        std::vector<std::vector<DebouncedButton::Input>> expected(32), actual(32);
+
+        for (uint32_t tick = 0; tick < 60000; ++tick) {
+            uint32_t tm = start_tm + tick;
+            uint32_t sample = 0;
+            for (int i = 0; i < 32; ++i) {
+                if (tick >= next_change_tick[i] && tick < 59000) {
+                    pressed[i] = !pressed[i];
+                    next_change_tick[i] = tick + hold_ms(_rng);
+                } else if (tick >= 59000) {
+                    pressed[i] = false;
+                }
+                bool reading = (i < 16) ? !pressed[i] : pressed[i];
+                sample |= uint32_t(reading) << i;
+
+                auto input = buttons[i].update(reading, tm);
+                if (input != DebouncedButton::NONE)
+                    expected[i].push_back(input);
+            }
+
+            bank.update(sample, tm, [&](uint8_t i, DebouncedButton::Input input) {
+                actual[i].push_back(input);
+            });
+        }
+
+        for (int i = 0; i < 32; ++i) {
+            SCOPED_TRACE("button " + std::to_string(i));
+            EXPECT_LT(50u, expected[i].size());
+            EXPECT_EQ(expected[i], actual[i]);
+        }
+        EXPECT_EQ(0u, bank.state());
+    }
+
+    DebouncedButton::reset_profiles();
+}
+
+/*---------------------------------------------------------------------------*/
+
+} // anonymous namespace